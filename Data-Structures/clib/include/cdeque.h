@@ -0,0 +1,168 @@
+/**
+ * File: cdeque.h
+ * --------------
+ * Generic, double ended queue interface, implemented as a growable circular buffer.
+ * Unlike CList, pushing and popping doesn't allocate and elements are contiguous
+ * (modulo wrap-around), so the deque is cheap as a queue, stack or sliding window.
+ * Pointers to elements are invalidated whenever the deque grows.
+ */
+
+#ifndef _CDEQUE_H_INCLUDED
+#define _CDEQUE_H_INCLUDED
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+typedef struct CDequeImplementation CDeque;
+typedef void (*CleanupElemFn)(void *element);
+
+/**
+ * Function: cdeque_create
+ * -----------------------
+ * Constructs a deque
+ * @param elem_size The size of each element in the deque
+ * @param capacity_hint Number of elements to make room for up front (may be 0)
+ * @param cleanupFn Cleanup function (may be NULL)
+ * @return Pointer to deque data structure, or NULL on allocation failure
+ */
+CDeque *cdeque_create(size_t elem_size, unsigned int capacity_hint, CleanupElemFn cleanupFn);
+
+/**
+ * Function: cdeque_dispose
+ * ------------------------
+ * Dispose of the deque and all elements in it
+ * @param dq The deque to dispose of
+ */
+void cdeque_dispose(CDeque *dq);
+
+/**
+ * Function: cdeque_clear
+ * ----------------------
+ * Removes all elements from the deque, keeping its capacity
+ * @param dq The deque to remove elements from
+ */
+void cdeque_clear(CDeque *dq);
+
+/**
+ * Function: cdeque_count
+ * ----------------------
+ * @param dq The deque to get the size of
+ * @return The number of elements in the deque
+ */
+int cdeque_count(const CDeque *dq);
+
+/**
+ * Function: cdeque_reserve
+ * ------------------------
+ * Makes sure that the deque can hold a number of elements without reallocating
+ * @param dq The deque to grow
+ * @param capacity The number of elements to make room for
+ * @return True if the deque has room for capacity elements, false on allocation failure
+ * or if capacity is above the largest power of two an unsigned int holds
+ */
+bool cdeque_reserve(CDeque *dq, unsigned int capacity);
+
+/**
+ * Function: cdeque_at
+ * -------------------
+ * Random access to the deque. Time complexity: O(1)
+ * @param dq The deque
+ * @param index Index of the element, counting from the front
+ * @return Pointer to the element at index
+ */
+void *cdeque_at(const CDeque *dq, int index);
+
+/**
+ * Function: cdeque_front
+ * ----------------------
+ * @param dq The deque to get the first element of
+ * @return Pointer to the first element, or NULL if empty
+ */
+void *cdeque_front(const CDeque *dq);
+
+/**
+ * Function: cdeque_back
+ * ---------------------
+ * @param dq The deque to get the last element of
+ * @return Pointer to the last element, or NULL if empty
+ */
+void *cdeque_back(const CDeque *dq);
+
+/**
+ * Function: cdeque_push_front
+ * ---------------------------
+ * @param dq The deque to add an element to
+ * @param data Pointer to the data to insert at the front of the deque
+ */
+void cdeque_push_front(CDeque *dq, const void *data);
+
+/**
+ * Function: cdeque_push_back
+ * --------------------------
+ * @param dq The deque to add an element to
+ * @param data Pointer to the data to put at the back of the deque
+ */
+void cdeque_push_back(CDeque *dq, const void *data);
+
+/**
+ * Function: cdeque_pop_front
+ * --------------------------
+ * Removes (and cleans up) the first element of the deque
+ * @param dq The deque to remove the first element from
+ */
+void cdeque_pop_front(CDeque *dq);
+
+/**
+ * Function: cdeque_pop_back
+ * -------------------------
+ * Removes (and cleans up) the last element of the deque
+ * @param dq The deque to remove the last element from
+ */
+void cdeque_pop_back(CDeque *dq);
+
+/**
+ * Function: cdeque_push_back_many
+ * -------------------------------
+ * Appends an array of elements to the back of the deque, in order
+ * @param dq The deque to add elements to
+ * @param src Array of elements
+ * @param n Number of elements in src
+ */
+void cdeque_push_back_many(CDeque *dq, const void *src, int n);
+
+/**
+ * Function: cdeque_push_front_many
+ * --------------------------------
+ * Prepends an array of elements to the front of the deque, so that
+ * afterwards src[0] is the front of the deque
+ * @param dq The deque to add elements to
+ * @param src Array of elements
+ * @param n Number of elements in src
+ */
+void cdeque_push_front_many(CDeque *dq, const void *src, int n);
+
+/**
+ * Function: cdeque_pop_front_many
+ * -------------------------------
+ * Moves up to n elements from the front of the deque into an array. The
+ * elements are not cleaned up; the caller becomes responsible for them.
+ * @param dq The deque to remove elements from
+ * @param dst Array to copy the elements into, in deque order
+ * @param n Maximum number of elements to remove
+ * @return The number of elements removed
+ */
+int cdeque_pop_front_many(CDeque *dq, void *dst, int n);
+
+/**
+ * Function: cdeque_pop_back_many
+ * ------------------------------
+ * Moves up to n elements from the back of the deque into an array. The
+ * elements are not cleaned up; the caller becomes responsible for them.
+ * @param dq The deque to remove elements from
+ * @param dst Array to copy the elements into, in deque order
+ * @param n Maximum number of elements to remove
+ * @return The number of elements removed
+ */
+int cdeque_pop_back_many(CDeque *dq, void *dst, int n);
+
+#endif // _CDEQUE_H_INCLUDED
@@ -0,0 +1,86 @@
+/**
+ * @file mpmc_queue.h
+ * @brief Bounded, lock-free, multi-producer multi-consumer FIFO queue
+ * @details Ring buffer of cells, each tagged with a sequence number which tells
+ * producers and consumers whether the cell is ready for them (Dmitry Vyukov's design).
+ * Producers and consumers only contend on a single atomic counter each.
+ */
+
+#ifndef _MPMC_QUEUE_H_INCLUDED
+#define _MPMC_QUEUE_H_INCLUDED
+
+#include "wait_strategy.h"
+#include <stdlib.h>
+#include <stdbool.h>
+
+typedef void (*CleanupElemFn)(void *addr);
+
+typedef struct MPMCQueueImplementation MPMCQueue;
+
+/**
+ * @fn mpmcq_create
+ * @brief Create a bounded multi-producer multi-consumer queue
+ * @param elem_size The size of each element in the queue
+ * @param capacity The maximum number of elements in the queue (rounded up to a power of two)
+ * @param wait What mpmcq_push/mpmcq_pop do while the queue is full/empty
+ * @param cleanup Function for disposing of elements left in the queue when it is disposed (may be NULL)
+ * @return Pointer to a new queue, or NULL on allocation failure
+ */
+MPMCQueue *mpmcq_create(size_t elem_size, unsigned int capacity, WaitStrategy wait, CleanupElemFn cleanup);
+
+/**
+ * @fn mpmcq_dispose
+ * @brief Dispose of the queue. No other thread may be using it.
+ * @param q The queue to dispose of
+ */
+void mpmcq_dispose(MPMCQueue *q);
+
+/**
+ * @fn mpmcq_try_push
+ * @param q The queue to append an element to
+ * @param data Pointer to the element to copy into the queue
+ * @return True if the element was pushed, false if the queue was full
+ */
+bool mpmcq_try_push(MPMCQueue *q, const void *data);
+
+/**
+ * @fn mpmcq_try_pop
+ * @brief Moves the front element out of the queue. The caller becomes responsible
+ * for cleaning it up.
+ * @param q The queue to remove the front element of
+ * @param dst Where to copy the front element to
+ * @return True if an element was popped, false if the queue was empty
+ */
+bool mpmcq_try_pop(MPMCQueue *q, void *dst);
+
+/**
+ * @fn mpmcq_push
+ * @brief Pushes an element, waiting while the queue is full
+ * @param q The queue to append an element to
+ * @param data Pointer to the element to copy into the queue
+ */
+void mpmcq_push(MPMCQueue *q, const void *data);
+
+/**
+ * @fn mpmcq_pop
+ * @brief Pops the front element, waiting while the queue is empty
+ * @param q The queue to remove the front element of
+ * @param dst Where to copy the front element to
+ */
+void mpmcq_pop(MPMCQueue *q, void *dst);
+
+/**
+ * @fn mpmcq_capacity
+ * @param q A queue
+ * @return The maximum number of elements the queue can hold
+ */
+unsigned int mpmcq_capacity(const MPMCQueue *q);
+
+/**
+ * @fn mpmcq_size
+ * @param q A queue
+ * @return The number of elements in the queue. Only a snapshot while other threads are using it.
+ */
+unsigned int mpmcq_size(const MPMCQueue *q);
+
+#endif // _MPMC_QUEUE_H_INCLUDED
@@ -0,0 +1,64 @@
+/**
+ * @file multiqueue.h
+ * @brief Relaxed concurrent priority queue (MultiQueue)
+ * @details The queue is made of c * P ordinary heaps, each with its own lock, for P threads.
+ * Push locks a random heap; pop looks at the tops of two random heaps and takes the better
+ * one. Threads rarely contend on the same lock, at the cost of exactness: pop returns an
+ * element which is near the top, with an expected rank error of O(c * P), rather than the
+ * top itself. Use test/multiqueue-rank.c to measure the error for a configuration.
+ */
+
+#ifndef _MULTIQUEUE_H_INCLUDED
+#define _MULTIQUEUE_H_INCLUDED
+
+#include "priority_queue.h"
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define MULTIQUEUE_DEFAULT_C 2
+
+typedef struct MultiQueueImplementation MultiQueue;
+
+/**
+ * @fn multiqueue_create
+ * @brief Create a relaxed concurrent priority queue
+ * @param elemsz Size of the element stored in the queue
+ * @param nthreads Number of threads which will use the queue
+ * @param c Number of heaps per thread. Passing 0 uses MULTIQUEUE_DEFAULT_C.
+ * @param cmp Function for comparing two elements (may not be NULL), as in pqueue_create
+ * @param cleanup Function for disposing of a single element (may be NULL)
+ * @return A pointer to a newly allocated queue, or NULL on allocation failure
+ */
+MultiQueue *multiqueue_create(size_t elemsz, int nthreads, int c, Cmp cmp, CleanupElemFn cleanup);
+
+/**
+ * @fn multiqueue_dispose
+ * @brief Dispose of the queue. No other thread may be using it.
+ * @param mq The queue to dispose of
+ */
+void multiqueue_dispose(MultiQueue *mq);
+
+/**
+ * @fn multiqueue_push
+ * @param mq The queue to push onto
+ * @param source Pointer to an element to copy into the queue
+ */
+void multiqueue_push(MultiQueue *mq, const void *source);
+
+/**
+ * @fn multiqueue_try_pop
+ * @brief Moves an element close to the top out of the queue. The caller becomes responsible for it.
+ * @param mq The queue to pop from
+ * @param dst Where to copy the element to
+ * @return True if an element was popped, false if the queue was empty
+ */
+bool multiqueue_try_pop(MultiQueue *mq, void *dst);
+
+/**
+ * @fn multiqueue_size
+ * @param mq A queue
+ * @return The number of elements in the queue. Only a snapshot while other threads are using it.
+ */
+int multiqueue_size(const MultiQueue *mq);
+
+#endif // _MULTIQUEUE_H_INCLUDED
@@ -0,0 +1,130 @@
+/**
+ * @file pairing_heap.h
+ * @brief A meldable priority queue using a pairing heap
+ * @details Unlike PriorityQueue, two pairing heaps can be melded in O(1), so merging
+ * per-shard queues doesn't touch their elements. Push and meld are O(1), pop and
+ * decrease-key are amortized O(log n). Nodes are carved out of large chunks by a pool
+ * allocator owned by the heap (and handed over on meld), so pushing doesn't malloc.
+ */
+
+#ifndef _PAIRING_HEAP_H_INCLUDED
+#define _PAIRING_HEAP_H_INCLUDED
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+typedef void (*CleanupElemFn)(void *addr);
+typedef bool (*Cmp)(const void* a, const void* b);
+
+typedef struct PairingHeapImplementation PairingHeap;
+
+/**
+ * @typedef PHNode
+ * @brief Handle to an element in a pairing heap, valid until the element is popped or removed.
+ * Stays valid when its heap is melded into another one.
+ */
+typedef struct PairingNode PHNode;
+
+/**
+ * @fn pheap_create
+ * @brief Create a pairing heap
+ * @param elemsz Size of the element stored in the heap
+ * @param cmp Function for comparing two elements (may not be NULL). Elements with the least value,
+ * using this comparison function, will be ranked first.
+ * @param cleanup Function for disposing of a single element (may be NULL)
+ * @return A pointer to a newly allocated pairing heap
+ */
+PairingHeap *pheap_create(size_t elemsz, Cmp cmp, CleanupElemFn cleanup);
+
+/**
+ * @fn pheap_dispose
+ * @param ph Pointer to a pairing heap to dispose of
+ */
+void pheap_dispose(PairingHeap *ph);
+
+/**
+ * @fn pheap_clear
+ * @brief Removes (and cleans up) all elements from the heap
+ * @param ph Pointer to a pairing heap
+ */
+void pheap_clear(PairingHeap *ph);
+
+/**
+ * @fn pheap_push
+ * @brief Copies an element into the heap. Time complexity: O(1)
+ * @param ph Pointer to a pairing heap
+ * @param source Pointer to the element to copy into the heap
+ * @return Handle to the pushed element
+ */
+PHNode *pheap_push(PairingHeap *ph, const void *source);
+
+/**
+ * @fn pheap_top
+ * @param ph Pointer to a pairing heap
+ * @return The element on the top of the heap, or NULL if it is empty
+ */
+void *pheap_top(const PairingHeap *ph);
+
+/**
+ * @fn pheap_pop
+ * @brief Removes (and cleans up) the top element. Time complexity: amortized O(log n)
+ * @param ph Pointer to a non-empty pairing heap
+ */
+void pheap_pop(PairingHeap *ph);
+
+/**
+ * @fn pheap_pop_into
+ * @brief Moves the top element out of the heap without cleaning it up
+ * @param ph Pointer to a non-empty pairing heap
+ * @param dst Where to copy the top element to
+ */
+void pheap_pop_into(PairingHeap *ph, void *dst);
+
+/**
+ * @fn pheap_get
+ * @param node Handle to an element in a heap
+ * @return Pointer to the element
+ */
+void *pheap_get(const PHNode *node);
+
+/**
+ * @fn pheap_decrease_key
+ * @brief Restores the heap order after the priority of an element was improved (decreased)
+ * in place through pheap_get. Time complexity: amortized O(log n)
+ * @param ph The heap containing the element
+ * @param node Handle to the element
+ */
+void pheap_decrease_key(PairingHeap *ph, PHNode *node);
+
+/**
+ * @fn pheap_remove
+ * @brief Removes (and cleans up) any element of the heap. Time complexity: amortized O(log n)
+ * @param ph The heap containing the element
+ * @param node Handle to the element
+ */
+void pheap_remove(PairingHeap *ph, PHNode *node);
+
+/**
+ * @fn pheap_meld
+ * @brief Moves all elements of one heap into another. Time complexity: O(1)
+ * @param into The heap to add the elements to
+ * @param from The heap to take the elements from, which is left empty. It must store
+ * elements of the same size and use the same comparison function.
+ */
+void pheap_meld(PairingHeap *into, PairingHeap *from);
+
+/**
+ * @fn pheap_empty
+ * @param ph Pointer to a pairing heap
+ * @return True if the heap is empty, false otherwise
+ */
+bool pheap_empty(const PairingHeap *ph);
+
+/**
+ * @fn pheap_size
+ * @param ph Pointer to a pairing heap
+ * @return The number of elements in the heap
+ */
+int pheap_size(const PairingHeap *ph);
+
+#endif // _PAIRING_HEAP_H_INCLUDED
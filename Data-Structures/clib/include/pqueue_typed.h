@@ -0,0 +1,127 @@
+/**
+ * @file pqueue_typed.h
+ * @brief Generates a priority queue specialized for one element type
+ * @details PQUEUE_DEFINE(name, type, less_expr) expands to a 4-ary min heap of type, with the
+ * same hole-based sifts as PriorityQueue. Since the element type and comparison are known at
+ * compile time, elements are moved with plain assignments instead of memcpy, and less_expr is
+ * inlined instead of called through a function pointer. less_expr compares two elements named
+ * a and b, for instance:
+ *
+ *   PQUEUE_DEFINE(EventQueue, Event, a.time < b.time)
+ *
+ *   EventQueue q;
+ *   EventQueue_init(&q, 0);
+ *   EventQueue_push(&q, event);
+ *   Event first = EventQueue_pop(&q);
+ *   EventQueue_destroy(&q);
+ *
+ * All functions are static inline, so the macro may be used in a header or in several files.
+ */
+
+#ifndef _PQUEUE_TYPED_H_INCLUDED
+#define _PQUEUE_TYPED_H_INCLUDED
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <assert.h>
+
+#define PQUEUE_TYPED_ARITY 4
+#define PQUEUE_TYPED_MIN_CAPACITY 16
+
+#define PQUEUE_DEFINE(name, type, less_expr)                                              \
+                                                                                          \
+typedef struct {                                                                          \
+  type *heap;                                                                             \
+  int nelems;                                                                             \
+  int capacity;                                                                           \
+} name;                                                                                   \
+                                                                                          \
+static inline bool name##_less(type a, type b) {                                          \
+  return (less_expr);                                                                     \
+}                                                                                         \
+                                                                                          \
+/* Makes room for at least capacity elements */                                           \
+static inline void name##_reserve(name *pq, int capacity) {                               \
+  if (capacity <= pq->capacity) return;                                                   \
+  if (capacity < 2 * pq->capacity) capacity = 2 * pq->capacity;                           \
+  if (capacity < PQUEUE_TYPED_MIN_CAPACITY) capacity = PQUEUE_TYPED_MIN_CAPACITY;         \
+  type *heap = realloc(pq->heap, capacity * sizeof(type));                                \
+  if (heap == NULL) {                                                                     \
+    perror(__func__);                                                                     \
+    exit(EXIT_FAILURE);                                                                   \
+  }                                                                                       \
+  pq->heap = heap;                                                                        \
+  pq->capacity = capacity;                                                                \
+}                                                                                         \
+                                                                                          \
+static inline void name##_init(name *pq, int capacity_hint) {                             \
+  pq->heap = NULL;                                                                        \
+  pq->nelems = 0;                                                                         \
+  pq->capacity = 0;                                                                       \
+  name##_reserve(pq, capacity_hint);                                                      \
+}                                                                                         \
+                                                                                          \
+static inline void name##_destroy(name *pq) {                                             \
+  free(pq->heap);                                                                         \
+  pq->heap = NULL;                                                                        \
+  pq->nelems = 0;                                                                         \
+  pq->capacity = 0;                                                                       \
+}                                                                                         \
+                                                                                          \
+static inline void name##_clear(name *pq) {                                               \
+  pq->nelems = 0;                                                                         \
+}                                                                                         \
+                                                                                          \
+static inline bool name##_empty(const name *pq) {                                         \
+  return pq->nelems == 0;                                                                 \
+}                                                                                         \
+                                                                                          \
+static inline int name##_size(const name *pq) {                                           \
+  return pq->nelems;                                                                      \
+}                                                                                         \
+                                                                                          \
+static inline type name##_top(const name *pq) {                                           \
+  assert(pq->nelems > 0);                                                                 \
+  return pq->heap[0];                                                                     \
+}                                                                                         \
+                                                                                          \
+/* Moves parents down into the hole until x fits there */                                 \
+static inline void name##_sift_up(name *pq, int hole, type x) {                           \
+  while (hole > 0) {                                                                      \
+    int parent = (hole - 1) / PQUEUE_TYPED_ARITY;                                         \
+    if (!name##_less(x, pq->heap[parent])) break;                                         \
+    pq->heap[hole] = pq->heap[parent];                                                    \
+    hole = parent;                                                                        \
+  }                                                                                       \
+  pq->heap[hole] = x;                                                                     \
+}                                                                                         \
+                                                                                          \
+static inline void name##_push(name *pq, type x) {                                        \
+  if (pq->nelems == pq->capacity) name##_reserve(pq, pq->nelems + 1);                     \
+  name##_sift_up(pq, pq->nelems++, x);                                                    \
+}                                                                                         \
+                                                                                          \
+/* Floyd's pop: carry the hole at the root down to a leaf, then sift the last element */  \
+/* up from there */                                                                       \
+static inline type name##_pop(name *pq) {                                                 \
+  assert(pq->nelems > 0);                                                                 \
+  type top = pq->heap[0];                                                                 \
+  int n = --pq->nelems;                                                                   \
+  if (n == 0) return top;                                                                 \
+                                                                                          \
+  type *heap = pq->heap;                                                                  \
+  int hole = 0;                                                                           \
+  for (int first = 1; first < n; first = PQUEUE_TYPED_ARITY * hole + 1) {                 \
+    int last = first + PQUEUE_TYPED_ARITY < n ? first + PQUEUE_TYPED_ARITY : n;           \
+    int best = first;                                                                     \
+    for (int i = first + 1; i < last; ++i)                                                \
+      if (name##_less(heap[i], heap[best])) best = i;                                     \
+    heap[hole] = heap[best];                                                              \
+    hole = best;                                                                          \
+  }                                                                                       \
+  name##_sift_up(pq, hole, heap[n]);                                                      \
+  return top;                                                                             \
+}
+
+#endif // _PQUEUE_TYPED_H_INCLUDED
@@ -1,6 +1,12 @@
 /**
  * @file priority_queue.h
- * @brief A priority queue using a min heap
+ * @brief A priority queue using a d-ary min heap
+ * @details The arity of the heap is chosen when the queue is created. Wider heaps are
+ * shallower, so pushes do fewer moves, and with a 4-ary heap of small elements the
+ * children of a node share a cache line. Elements are moved into a "hole" once per level
+ * instead of being swapped, and pop uses Floyd's bottom-up sift: the hole is carried
+ * down to a leaf along the smallest children, and the last element is sifted up from
+ * there, which saves about half the comparisons since it usually belongs near the bottom.
  */
 
 #ifndef PRIORITYQUEUE_LIBRARY_H
@@ -8,23 +14,61 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef void (*CleanupElemFn)(void *addr);
 typedef bool (*Cmp)(const void* a, const void* b);
 
 typedef struct PriorityQueueImplementation PriorityQueue;
 
+/**
+ * @typedef PQHandle
+ * @brief Refers to an element of an addressable priority queue for as long as the element
+ * is in the queue. Once the element is popped, removed or cleared, pqueue_contains is false
+ * for the handle, even after its slot is given to a newer element: handles carry a
+ * generation which changes every time their slot is freed.
+ */
+typedef int64_t PQHandle;
+#define PQ_NO_HANDLE (-1)
+
+#define PQUEUE_DEFAULT_ARITY 4
+
 /**
  * @fn pqueue_create
  * @brief Create a priority queue object
  * @param elemsz Size of the element stored in the priority queue
  * @param capacity_hint Hint for initial capacity of priority queue
+ * @param arity Number of children of each node of the heap: 2, 4 or 8 are sensible
+ * choices. Passing 0 uses PQUEUE_DEFAULT_ARITY.
  * @param cmp Function for comparing two elements (may not be NULL). Elements with the least value, using
  * this comparison function will be ranked first in the priority queue
  * @param cleanup Function for disposing of a single element (may be null)
  * @return A pointer to a newly allocated priority queue object
  */
-PriorityQueue *pqueue_create(size_t elemsz, unsigned int capacity_hint, Cmp cmp, CleanupElemFn cleanup);
+PriorityQueue *pqueue_create(size_t elemsz, unsigned int capacity_hint, unsigned int arity,
+                             Cmp cmp, CleanupElemFn cleanup);
+
+/**
+ * @fn pqueue_create_addressable
+ * @brief Create a priority queue whose elements can be looked up, updated and removed
+ * through the handles returned by pqueue_push, at the cost of maintaining a position
+ * array during every sift. Parameters are the same as pqueue_create.
+ * @return A pointer to a newly allocated priority queue object
+ */
+PriorityQueue *pqueue_create_addressable(size_t elemsz, unsigned int capacity_hint, unsigned int arity,
+                                         Cmp cmp, CleanupElemFn cleanup);
+
+/**
+ * @fn pqueue_create_from
+ * @brief Create a priority queue holding a copy of an array of elements, which are
+ * heapified in O(n) time rather than pushed one at a time in O(n log n)
+ * @param array The elements to copy into the queue
+ * @param n The number of elements in array
+ * Other parameters are the same as pqueue_create.
+ * @return A pointer to a newly allocated priority queue object
+ */
+PriorityQueue *pqueue_create_from(const void *array, int n, size_t elemsz, unsigned int arity,
+                                  Cmp cmp, CleanupElemFn cleanup);
 
 /**
  * @fn pqueue_dispose
@@ -46,12 +90,67 @@ void* pqueue_top(const PriorityQueue *pq);
  */
 void pqueue_pop(PriorityQueue* pq);
 
+/**
+ * @fn pqueue_pop_into
+ * @brief Moves the top element out of the priority queue. It is not cleaned up; the
+ * caller becomes responsible for it.
+ * @param pq Pointer to a (non-empty) priority queue
+ * @param dst Where to copy the top element to
+ */
+void pqueue_pop_into(PriorityQueue* pq, void *dst);
+
 /**
  * @fn pqueue_push
  * @param pq Pointer to a priority queue
  * @param source Pointer to an element to copy into the queue
+ * @return Handle to the pushed element if the queue is addressable, otherwise PQ_NO_HANDLE
+ */
+PQHandle pqueue_push(PriorityQueue *pq, const void *source);
+
+/**
+ * @fn pqueue_push_many
+ * @brief Pushes an array of elements. If the batch is large compared to the queue, the
+ * elements are appended and the whole heap is rebuilt in O(n) instead of sifting each one.
+ * @param pq Pointer to a priority queue
+ * @param source Array of elements to copy into the queue
+ * @param n Number of elements in source
+ * @param handles If not NULL and the queue is addressable, receives the handle of each element
+ */
+void pqueue_push_many(PriorityQueue *pq, const void *source, int n, PQHandle *handles);
+
+/**
+ * @fn pqueue_contains
+ * @param pq Pointer to an addressable priority queue
+ * @param handle A handle returned by pqueue_push
+ * @return True if the element referred to by handle is still in the queue
+ */
+bool pqueue_contains(const PriorityQueue *pq, PQHandle handle);
+
+/**
+ * @fn pqueue_get
+ * @param pq Pointer to an addressable priority queue
+ * @param handle Handle of an element in the queue
+ * @return Pointer to the element. If its priority is modified through this pointer,
+ * pqueue_update must be called before the queue is used again.
+ */
+void* pqueue_get(const PriorityQueue *pq, PQHandle handle);
+
+/**
+ * @fn pqueue_update
+ * @brief Restores the heap order after the priority of an element was changed in place
+ * (increased or decreased). Time complexity: O(log n)
+ * @param pq Pointer to an addressable priority queue
+ * @param handle Handle of the element which was changed
+ */
+void pqueue_update(PriorityQueue *pq, PQHandle handle);
+
+/**
+ * @fn pqueue_remove
+ * @brief Removes (and cleans up) an element which need not be the top. Time complexity: O(log n)
+ * @param pq Pointer to an addressable priority queue
+ * @param handle Handle of the element to remove
  */
-void pqueue_push(PriorityQueue *pq, const void *source);
+void pqueue_remove(PriorityQueue *pq, PQHandle handle);
 
 /**
  * @fn pqueue_clear
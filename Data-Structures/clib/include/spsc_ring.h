@@ -0,0 +1,117 @@
+/**
+ * @file spsc_ring.h
+ * @brief Bounded single-producer single-consumer ring buffer
+ * @details Producer and consumer state are kept on separate cache lines and each
+ * side caches the other's index so that the shared indices are only read when the
+ * ring looks full/empty. Elements may be staged and published in batches, so that
+ * many elements cost a single release store.
+ */
+
+#ifndef _SPSC_RING_H_INCLUDED
+#define _SPSC_RING_H_INCLUDED
+
+#include "wait_strategy.h"
+#include <stdlib.h>
+#include <stdbool.h>
+
+typedef void (*CleanupElemFn)(void *addr);
+
+typedef struct SPSCRingImplementation SPSCRing;
+
+/**
+ * @fn spsc_create
+ * @brief Create a bounded single-producer single-consumer ring
+ * @param elem_size The size of each element in the ring
+ * @param capacity The maximum number of elements in the ring (rounded up to a power of two)
+ * @param wait What spsc_push/spsc_pop do while the ring is full/empty
+ * @param cleanup Function for disposing of elements left in the ring when it is disposed (may be NULL)
+ * @return Pointer to a new ring, or NULL on allocation failure
+ */
+SPSCRing *spsc_create(size_t elem_size, unsigned int capacity, WaitStrategy wait, CleanupElemFn cleanup);
+
+/**
+ * @fn spsc_dispose
+ * @brief Dispose of the ring. Neither the producer nor consumer may be using it.
+ * @param r The ring to dispose of
+ */
+void spsc_dispose(SPSCRing *r);
+
+/**
+ * @fn spsc_stage
+ * @brief Producer only. Copies an element into the ring without making it visible to the consumer.
+ * @param r The ring
+ * @param data Pointer to the element to copy into the ring
+ * @return True if the element was staged, false if the ring is full
+ */
+bool spsc_stage(SPSCRing *r, const void *data);
+
+/**
+ * @fn spsc_publish
+ * @brief Producer only. Makes all staged elements visible to the consumer.
+ * @param r The ring
+ */
+void spsc_publish(SPSCRing *r);
+
+/**
+ * @fn spsc_try_push
+ * @brief Producer only. Stage and publish a single element.
+ * @param r The ring
+ * @param data Pointer to the element to copy into the ring
+ * @return True if the element was pushed, false if the ring is full
+ */
+bool spsc_try_push(SPSCRing *r, const void *data);
+
+/**
+ * @fn spsc_try_push_many
+ * @brief Producer only. Copies as many of the elements as fit with (at most) two memcpy's
+ * and publishes them at once.
+ * @param r The ring
+ * @param src Array of elements to push
+ * @param n Number of elements in src
+ * @return The number of elements pushed
+ */
+unsigned int spsc_try_push_many(SPSCRing *r, const void *src, unsigned int n);
+
+/**
+ * @fn spsc_try_pop
+ * @brief Consumer only. Moves the front element out of the ring.
+ * @param r The ring
+ * @param dst Where to copy the front element to
+ * @return True if an element was popped, false if the ring was empty
+ */
+bool spsc_try_pop(SPSCRing *r, void *dst);
+
+/**
+ * @fn spsc_try_pop_many
+ * @brief Consumer only. Moves up to n elements out of the ring at once.
+ * @param r The ring
+ * @param dst Array to copy the elements to
+ * @param n Maximum number of elements to pop
+ * @return The number of elements popped
+ */
+unsigned int spsc_try_pop_many(SPSCRing *r, void *dst, unsigned int n);
+
+/**
+ * @fn spsc_push
+ * @brief Producer only. Pushes an element, waiting while the ring is full.
+ * @param r The ring
+ * @param data Pointer to the element to copy into the ring
+ */
+void spsc_push(SPSCRing *r, const void *data);
+
+/**
+ * @fn spsc_pop
+ * @brief Consumer only. Pops the front element, waiting while the ring is empty.
+ * @param r The ring
+ * @param dst Where to copy the front element to
+ */
+void spsc_pop(SPSCRing *r, void *dst);
+
+/**
+ * @fn spsc_capacity
+ * @param r A ring
+ * @return The maximum number of elements the ring can hold
+ */
+unsigned int spsc_capacity(const SPSCRing *r);
+
+#endif // _SPSC_RING_H_INCLUDED
@@ -0,0 +1,99 @@
+/**
+ * @file timing_wheel.h
+ * @brief Hierarchical timing wheel for large numbers of mostly cancelled timers
+ * @details Four wheels of 256 slots each cover 2^32 ticks from the current time. A timer
+ * goes into the slot of the coarsest wheel it needs, and is moved down ("cascaded") into a
+ * finer wheel when the wheel below it wraps around, so insert and cancel are O(1) and each
+ * tick only touches the slot which expires. Timers further in the future than the wheels
+ * reach wait in an addressable PriorityQueue until they come into range.
+ * Expired timers are handed to a callback in batches of contiguous elements.
+ */
+
+#ifndef _TIMING_WHEEL_H_INCLUDED
+#define _TIMING_WHEEL_H_INCLUDED
+
+#include "priority_queue.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct TimingWheelImplementation TimingWheel;
+
+/**
+ * @typedef Timer
+ * @brief Handle to a pending timer. Invalid once the timer has expired or been cancelled.
+ */
+typedef struct TimerImplementation Timer;
+
+/**
+ * @typedef TimerExpireFn
+ * @brief Called with a batch of expired timers' elements. The callback owns (and should
+ * clean up) the elements and may insert or cancel other timers.
+ * @param elems Array of n elements
+ * @param n Number of elements in the batch
+ * @param arg The argument given to twheel_create
+ */
+typedef void (*TimerExpireFn)(void *elems, int n, void *arg);
+
+/**
+ * @fn twheel_create
+ * @brief Create a timing wheel
+ * @param elemsz Size of the element stored with each timer
+ * @param now The current time, in ticks
+ * @param expire Callback for batches of expired timers (may not be NULL)
+ * @param arg Passed along to expire
+ * @param cleanup Function for disposing of the element of a cancelled timer (may be NULL)
+ * @return Pointer to a new timing wheel
+ */
+TimingWheel *twheel_create(size_t elemsz, uint64_t now, TimerExpireFn expire, void *arg,
+                           CleanupElemFn cleanup);
+
+/**
+ * @fn twheel_dispose
+ * @brief Dispose of the wheel, cleaning up the elements of all pending timers
+ * @param tw The timing wheel to dispose of
+ */
+void twheel_dispose(TimingWheel *tw);
+
+/**
+ * @fn twheel_insert
+ * @brief Schedules a timer. Time complexity: O(1), or O(log n) beyond the range of the wheels.
+ * @param tw The timing wheel
+ * @param expires The tick at which the timer expires. Times which already passed expire
+ * on the next tick.
+ * @param data Pointer to the element to copy into the timer
+ * @return Handle to the timer
+ */
+Timer *twheel_insert(TimingWheel *tw, uint64_t expires, const void *data);
+
+/**
+ * @fn twheel_cancel
+ * @brief Cancels a pending timer, cleaning up its element. Time complexity: O(1), or
+ * O(log n) beyond the range of the wheels.
+ * @param tw The timing wheel
+ * @param timer The timer to cancel
+ */
+void twheel_cancel(TimingWheel *tw, Timer *timer);
+
+/**
+ * @fn twheel_advance
+ * @brief Moves time forward, expiring every timer due at or before now
+ * @param tw The timing wheel
+ * @param now The new current time, in ticks
+ */
+void twheel_advance(TimingWheel *tw, uint64_t now);
+
+/**
+ * @fn twheel_now
+ * @param tw The timing wheel
+ * @return The current time, in ticks. While expire callbacks run, the tick being expired.
+ */
+uint64_t twheel_now(const TimingWheel *tw);
+
+/**
+ * @fn twheel_count
+ * @param tw The timing wheel
+ * @return The number of pending timers
+ */
+int twheel_count(const TimingWheel *tw);
+
+#endif // _TIMING_WHEEL_H_INCLUDED
@@ -0,0 +1,88 @@
+/**
+ * @file wait_strategy.h
+ * @brief Spinning and blocking wait strategies shared by the concurrent queues
+ */
+
+#ifndef _WAIT_STRATEGY_H_INCLUDED
+#define _WAIT_STRATEGY_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define CACHE_LINE_SIZE 64
+
+/**
+ * @enum WaitStrategy
+ * @brief What a thread does while a queue is full (push) or empty (pop)
+ * WAIT_SPIN: busy-wait (yielding the CPU now and then), lowest latency
+ * WAIT_BLOCK: spin briefly, then sleep on a condition variable until notified
+ */
+typedef enum { WAIT_SPIN, WAIT_BLOCK } WaitStrategy;
+
+/**
+ * @typedef TryOpFn
+ * @brief A non-blocking queue operation (e.g. try_push or try_pop) which returns
+ * true if it succeeded and false if it should be retried later
+ */
+typedef bool (*TryOpFn)(void *queue, void *elem);
+
+/**
+ * @struct Waiter
+ * @brief Place for threads to sleep on until another thread makes progress
+ * @details An event count: sleepers wait for the epoch to move past the value
+ * they observed before their last failed attempt.
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  atomic_uint epoch;
+  atomic_int sleepers;
+} Waiter;
+
+/**
+ * @fn cpu_relax
+ * @brief Hint to the processor that we are in a spin-wait loop
+ */
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#else
+  sched_yield();
+#endif
+}
+
+/**
+ * @fn waiter_init
+ * @param w Waiter to initialize
+ */
+void waiter_init(Waiter *w);
+
+/**
+ * @fn waiter_destroy
+ * @param w Waiter to release the resources of
+ */
+void waiter_destroy(Waiter *w);
+
+/**
+ * @fn waiter_run
+ * @brief Retries an operation until it succeeds, waiting in between according to a strategy
+ * @param w The waiter to sleep on (only used by WAIT_BLOCK)
+ * @param strategy How to wait between attempts
+ * @param op The operation to retry
+ * @param queue First argument to op
+ * @param elem Second argument to op
+ */
+void waiter_run(Waiter *w, WaitStrategy strategy, TryOpFn op, void *queue, void *elem);
+
+/**
+ * @fn waiter_notify
+ * @brief Wake up any threads sleeping on a waiter. Cheap if nobody is sleeping.
+ * @param w The waiter to wake sleeping threads of
+ */
+void waiter_notify(Waiter *w);
+
+#endif // _WAIT_STRATEGY_H_INCLUDED
@@ -0,0 +1,240 @@
+
+#include <cdeque.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+
+#define ASSERT_NOT_NULL(x) assert((x) != NULL);
+#define DEFAULT_CAPACITY 16
+#define MAX_CAPACITY (UINT_MAX / 2 + 1)
+
+/**
+ * @struct CDequeImplementation: Circular buffer meta-data
+ * The elements live at slots head, head + 1, ..., head + nelems - 1 (mod capacity).
+ * Capacity is always a power of two so that wrapping is a mask.
+ */
+struct CDequeImplementation {
+  char *buffer;
+  unsigned int capacity;
+  unsigned int head;
+  int nelems;
+  size_t elem_size;
+  CleanupElemFn cleanup;
+};
+
+// Static function declarations
+static inline unsigned int slot_of(const CDeque *dq, int index);
+static inline void *el_at(const CDeque *dq, unsigned int slot);
+static void ensure_room(CDeque *dq, int n);
+static void copy_in(CDeque *dq, unsigned int slot, const void *src, int n);
+static void copy_out(const CDeque *dq, unsigned int slot, void *dst, int n);
+
+CDeque *cdeque_create(size_t elem_size, unsigned int capacity_hint, CleanupElemFn cleanupFn) {
+  CDeque *dq = malloc(sizeof(CDeque));
+  if (dq == NULL) return NULL;
+  dq->buffer = NULL;
+  dq->capacity = 0;
+  dq->head = 0;
+  dq->nelems = 0;
+  dq->elem_size = elem_size;
+  dq->cleanup = cleanupFn;
+
+  if (!cdeque_reserve(dq, capacity_hint ? capacity_hint : DEFAULT_CAPACITY)) {
+    free(dq);
+    return NULL;
+  }
+  return dq;
+}
+
+void cdeque_dispose(CDeque *dq) {
+  ASSERT_NOT_NULL(dq);
+  cdeque_clear(dq);
+  free(dq->buffer);
+  free(dq);
+}
+
+void cdeque_clear(CDeque *dq) {
+  ASSERT_NOT_NULL(dq);
+  if (dq->cleanup != NULL) {
+    for (int i = 0; i < dq->nelems; ++i)
+      dq->cleanup(el_at(dq, slot_of(dq, i)));
+  }
+  dq->head = 0;
+  dq->nelems = 0;
+}
+
+int cdeque_count(const CDeque *dq) {
+  ASSERT_NOT_NULL(dq);
+  return dq->nelems;
+}
+
+bool cdeque_reserve(CDeque *dq, unsigned int capacity) {
+  ASSERT_NOT_NULL(dq);
+  if (capacity <= dq->capacity) return true;
+  // The capacity stays a power of two, so doubling past the largest one would wrap to 0
+  if (capacity > MAX_CAPACITY) return false;
+
+  unsigned int new_capacity = dq->capacity ? dq->capacity : 1;
+  while (new_capacity < capacity) new_capacity *= 2;
+  if (new_capacity > SIZE_MAX / dq->elem_size) return false;
+
+  char *buffer = realloc(dq->buffer, new_capacity * dq->elem_size);
+  if (buffer == NULL) return false;
+
+  // If the elements wrapped around the end of the old buffer, move the
+  // wrapped part to just after the old end, where it is contiguous again
+  // (the new capacity is at least double so it always fits)
+  unsigned int end = dq->head + dq->nelems;
+  if (end > dq->capacity) {
+    size_t wrapped = end - dq->capacity;
+    memcpy(buffer + dq->capacity * dq->elem_size, buffer, wrapped * dq->elem_size);
+  }
+
+  dq->buffer = buffer;
+  dq->capacity = new_capacity;
+  return true;
+}
+
+void *cdeque_at(const CDeque *dq, int index) {
+  ASSERT_NOT_NULL(dq);
+  assert(index >= 0);
+  assert(index < dq->nelems);
+  return el_at(dq, slot_of(dq, index));
+}
+
+void *cdeque_front(const CDeque *dq) {
+  ASSERT_NOT_NULL(dq);
+  if (dq->nelems == 0) return NULL;
+  return el_at(dq, dq->head);
+}
+
+void *cdeque_back(const CDeque *dq) {
+  ASSERT_NOT_NULL(dq);
+  if (dq->nelems == 0) return NULL;
+  return el_at(dq, slot_of(dq, dq->nelems - 1));
+}
+
+void cdeque_push_front(CDeque *dq, const void *data) {
+  ASSERT_NOT_NULL(dq);
+  ASSERT_NOT_NULL(data);
+  ensure_room(dq, 1);
+  dq->head = (dq->head - 1) & (dq->capacity - 1);
+  memcpy(el_at(dq, dq->head), data, dq->elem_size);
+  dq->nelems++;
+}
+
+void cdeque_push_back(CDeque *dq, const void *data) {
+  ASSERT_NOT_NULL(dq);
+  ASSERT_NOT_NULL(data);
+  ensure_room(dq, 1);
+  memcpy(el_at(dq, slot_of(dq, dq->nelems)), data, dq->elem_size);
+  dq->nelems++;
+}
+
+void cdeque_pop_front(CDeque *dq) {
+  ASSERT_NOT_NULL(dq);
+  if (dq->nelems == 0) return;
+  if (dq->cleanup != NULL) dq->cleanup(el_at(dq, dq->head));
+  dq->head = (dq->head + 1) & (dq->capacity - 1);
+  dq->nelems--;
+}
+
+void cdeque_pop_back(CDeque *dq) {
+  ASSERT_NOT_NULL(dq);
+  if (dq->nelems == 0) return;
+  if (dq->cleanup != NULL) dq->cleanup(cdeque_back(dq));
+  dq->nelems--;
+}
+
+void cdeque_push_back_many(CDeque *dq, const void *src, int n) {
+  ASSERT_NOT_NULL(dq);
+  assert(n >= 0);
+  if (n == 0) return;
+  ASSERT_NOT_NULL(src);
+  ensure_room(dq, n);
+  copy_in(dq, slot_of(dq, dq->nelems), src, n);
+  dq->nelems += n;
+}
+
+void cdeque_push_front_many(CDeque *dq, const void *src, int n) {
+  ASSERT_NOT_NULL(dq);
+  assert(n >= 0);
+  if (n == 0) return;
+  ASSERT_NOT_NULL(src);
+  ensure_room(dq, n);
+  dq->head = (dq->head - n) & (dq->capacity - 1);
+  copy_in(dq, dq->head, src, n);
+  dq->nelems += n;
+}
+
+int cdeque_pop_front_many(CDeque *dq, void *dst, int n) {
+  ASSERT_NOT_NULL(dq);
+  if (n > dq->nelems) n = dq->nelems;
+  if (n <= 0) return 0;
+  copy_out(dq, dq->head, dst, n);
+  dq->head = (dq->head + n) & (dq->capacity - 1);
+  dq->nelems -= n;
+  return n;
+}
+
+int cdeque_pop_back_many(CDeque *dq, void *dst, int n) {
+  ASSERT_NOT_NULL(dq);
+  if (n > dq->nelems) n = dq->nelems;
+  if (n <= 0) return 0;
+  copy_out(dq, slot_of(dq, dq->nelems - n), dst, n);
+  dq->nelems -= n;
+  return n;
+}
+
+/**
+ * Function: slot_of
+ * -----------------
+ * @return The slot in the buffer holding the element at index
+ */
+static inline unsigned int slot_of(const CDeque *dq, int index) {
+  return (dq->head + (unsigned int) index) & (dq->capacity - 1);
+}
+
+static inline void *el_at(const CDeque *dq, unsigned int slot) {
+  return dq->buffer + slot * dq->elem_size;
+}
+
+/**
+ * Function: ensure_room
+ * ---------------------
+ * Grows the deque so that n more elements fit, exiting if out of memory
+ */
+static void ensure_room(CDeque *dq, int n) {
+  unsigned int needed = (unsigned int) dq->nelems + (unsigned int) n; // both are non-negative ints, so no wrap
+  if (needed <= dq->capacity) return;
+  if (!cdeque_reserve(dq, needed)) {
+    perror(__func__);
+    exit(EXIT_FAILURE);
+  }
+}
+
+/**
+ * Function: copy_in
+ * -----------------
+ * Copies n elements into consecutive slots starting at slot, in at most two spans
+ */
+static void copy_in(CDeque *dq, unsigned int slot, const void *src, int n) {
+  unsigned int first = dq->capacity - slot;
+  if (first > (unsigned int) n) first = (unsigned int) n;
+  memcpy(el_at(dq, slot), src, first * dq->elem_size);
+  memcpy(dq->buffer, (const char *) src + first * dq->elem_size, (n - first) * dq->elem_size);
+}
+
+/**
+ * Function: copy_out
+ * ------------------
+ * Copies n elements out of consecutive slots starting at slot, in at most two spans
+ */
+static void copy_out(const CDeque *dq, unsigned int slot, void *dst, int n) {
+  unsigned int first = dq->capacity - slot;
+  if (first > (unsigned int) n) first = (unsigned int) n;
+  memcpy(dst, el_at(dq, slot), first * dq->elem_size);
+  memcpy((char *) dst + first * dq->elem_size, dq->buffer, (n - first) * dq->elem_size);
+}
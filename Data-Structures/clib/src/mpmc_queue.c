@@ -0,0 +1,168 @@
+/**
+ * @file mpmc_queue.c
+ * @brief Implementation of the bounded multi-producer multi-consumer queue
+ */
+
+#include "mpmc_queue.h"
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+/**
+ * @struct cell
+ * @brief One slot of the ring. A cell at position pos is writable when seq == pos
+ * and readable when seq == pos + 1.
+ */
+struct cell {
+  atomic_size_t seq;
+  char data[];
+};
+
+/**
+ * @struct MPMCQueueImplementation
+ * @brief The two hot counters live on their own cache lines so that producers
+ * and consumers don't invalidate each other's lines
+ */
+struct MPMCQueueImplementation {
+  _Alignas(CACHE_LINE_SIZE) atomic_size_t enqueue_pos;
+  _Alignas(CACHE_LINE_SIZE) atomic_size_t dequeue_pos;
+
+  _Alignas(CACHE_LINE_SIZE) char *cells;
+  size_t mask;                  // capacity - 1
+  size_t elem_size;
+  size_t cell_size;             // cell header + element, padded for alignment of seq
+  WaitStrategy wait;
+  CleanupElemFn cleanup;
+
+  Waiter not_empty;             // consumers sleep here
+  Waiter not_full;              // producers sleep here
+};
+
+static inline struct cell *cell_at(const MPMCQueue *q, size_t pos);
+static bool try_push_op(void *q, void *data);
+static bool try_pop_op(void *q, void *dst);
+
+MPMCQueue *mpmcq_create(size_t elem_size, unsigned int capacity, WaitStrategy wait, CleanupElemFn cleanup) {
+  if (elem_size == 0 || capacity == 0) return NULL;
+
+  size_t nslots = 1;
+  while (nslots < capacity) nslots <<= 1;
+
+  size_t size = (sizeof(MPMCQueue) + CACHE_LINE_SIZE - 1) & ~((size_t) CACHE_LINE_SIZE - 1);
+  MPMCQueue *q = aligned_alloc(CACHE_LINE_SIZE, size);
+  if (q == NULL) return NULL;
+
+  q->elem_size = elem_size;
+  q->cell_size = sizeof(struct cell) + elem_size;
+  q->cell_size = (q->cell_size + _Alignof(struct cell) - 1) & ~(_Alignof(struct cell) - 1);
+  q->mask = nslots - 1;
+  q->wait = wait;
+  q->cleanup = cleanup;
+
+  q->cells = malloc(nslots * q->cell_size);
+  if (q->cells == NULL) {
+    free(q);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < nslots; ++i)
+    atomic_init(&cell_at(q, i)->seq, i);
+  atomic_init(&q->enqueue_pos, 0);
+  atomic_init(&q->dequeue_pos, 0);
+
+  waiter_init(&q->not_empty);
+  waiter_init(&q->not_full);
+  return q;
+}
+
+void mpmcq_dispose(MPMCQueue *q) {
+  assert(q != NULL);
+  if (q->cleanup) {
+    size_t end = atomic_load(&q->enqueue_pos);
+    for (size_t pos = atomic_load(&q->dequeue_pos); pos != end; ++pos)
+      q->cleanup(cell_at(q, pos)->data);
+  }
+  waiter_destroy(&q->not_empty);
+  waiter_destroy(&q->not_full);
+  free(q->cells);
+  free(q);
+}
+
+bool mpmcq_try_push(MPMCQueue *q, const void *data) {
+  struct cell *c;
+  size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+  for (;;) {
+    c = cell_at(q, pos);
+    size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+    intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+    if (diff == 0) {
+      // The cell is free for this lap, try to claim it
+      if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false; // The cell still holds an element from the previous lap: full
+    } else {
+      pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    }
+  }
+
+  memcpy(c->data, data, q->elem_size);
+  atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+  if (q->wait == WAIT_BLOCK) waiter_notify(&q->not_empty);
+  return true;
+}
+
+bool mpmcq_try_pop(MPMCQueue *q, void *dst) {
+  struct cell *c;
+  size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+  for (;;) {
+    c = cell_at(q, pos);
+    size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+    intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false; // Nothing has been written to this cell yet: empty
+    } else {
+      pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    }
+  }
+
+  memcpy(dst, c->data, q->elem_size);
+  atomic_store_explicit(&c->seq, pos + q->mask + 1, memory_order_release); // free for the next lap
+  if (q->wait == WAIT_BLOCK) waiter_notify(&q->not_full);
+  return true;
+}
+
+void mpmcq_push(MPMCQueue *q, const void *data) {
+  waiter_run(&q->not_full, q->wait, try_push_op, q, (void *) data);
+}
+
+void mpmcq_pop(MPMCQueue *q, void *dst) {
+  waiter_run(&q->not_empty, q->wait, try_pop_op, q, dst);
+}
+
+unsigned int mpmcq_capacity(const MPMCQueue *q) {
+  return (unsigned int) (q->mask + 1);
+}
+
+unsigned int mpmcq_size(const MPMCQueue *q) {
+  size_t head = atomic_load_explicit(&((MPMCQueue *) q)->dequeue_pos, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(&((MPMCQueue *) q)->enqueue_pos, memory_order_relaxed);
+  return tail > head ? (unsigned int) (tail - head) : 0;
+}
+
+static inline struct cell *cell_at(const MPMCQueue *q, size_t pos) {
+  return (struct cell *) (q->cells + (pos & q->mask) * q->cell_size);
+}
+
+static bool try_push_op(void *q, void *data) {
+  return mpmcq_try_push(q, data);
+}
+
+static bool try_pop_op(void *q, void *dst) {
+  return mpmcq_try_pop(q, dst);
+}
@@ -0,0 +1,164 @@
+/**
+ * @file multiqueue.c
+ * @brief Implementation of the relaxed concurrent priority queue
+ */
+
+#include "multiqueue.h"
+#include "wait_strategy.h"
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <assert.h>
+
+// Random pairs to try before popping gives up on sampling and scans every heap
+#define MAX_SAMPLES 64
+
+/**
+ * @struct heap
+ * @brief One of the internal heaps, alone on its cache line(s) with its lock
+ */
+struct heap {
+  _Alignas(CACHE_LINE_SIZE) pthread_mutex_t lock;
+  PriorityQueue *pq;
+};
+
+struct MultiQueueImplementation {
+  struct heap *heaps;
+  int nheaps;
+  size_t elemsz;
+  Cmp cmp;
+  _Alignas(CACHE_LINE_SIZE) atomic_int nelems;
+};
+
+static inline unsigned int random_heap(const MultiQueue *mq);
+static bool pop_scan(MultiQueue *mq, void *dst);
+
+MultiQueue *multiqueue_create(size_t elemsz, int nthreads, int c, Cmp cmp, CleanupElemFn cleanup) {
+  assert(cmp != NULL);
+  if (nthreads < 1) nthreads = 1;
+  if (c < 1) c = MULTIQUEUE_DEFAULT_C;
+
+  size_t size = (sizeof(MultiQueue) + CACHE_LINE_SIZE - 1) & ~((size_t) CACHE_LINE_SIZE - 1);
+  MultiQueue *mq = aligned_alloc(CACHE_LINE_SIZE, size);
+  if (mq == NULL) return NULL;
+
+  mq->nheaps = c * nthreads;
+  mq->elemsz = elemsz;
+  mq->cmp = cmp;
+  atomic_init(&mq->nelems, 0);
+
+  mq->heaps = aligned_alloc(CACHE_LINE_SIZE, mq->nheaps * sizeof(struct heap));
+  if (mq->heaps == NULL) {
+    free(mq);
+    return NULL;
+  }
+
+  for (int i = 0; i < mq->nheaps; ++i) {
+    pthread_mutex_init(&mq->heaps[i].lock, NULL);
+    mq->heaps[i].pq = pqueue_create(elemsz, 0, 0, cmp, cleanup);
+  }
+  return mq;
+}
+
+void multiqueue_dispose(MultiQueue *mq) {
+  assert(mq != NULL);
+  for (int i = 0; i < mq->nheaps; ++i) {
+    pqueue_dispose(mq->heaps[i].pq);
+    pthread_mutex_destroy(&mq->heaps[i].lock);
+  }
+  free(mq->heaps);
+  free(mq);
+}
+
+void multiqueue_push(MultiQueue *mq, const void *source) {
+  struct heap *h;
+  do h = &mq->heaps[random_heap(mq)];
+  while (pthread_mutex_trylock(&h->lock) != 0); // busy, just pick another one
+
+  pqueue_push(h->pq, source);
+  pthread_mutex_unlock(&h->lock);
+  atomic_fetch_add_explicit(&mq->nelems, 1, memory_order_relaxed);
+}
+
+bool multiqueue_try_pop(MultiQueue *mq, void *dst) {
+  for (int sample = 0; sample < MAX_SAMPLES; ++sample) {
+    if (atomic_load_explicit(&mq->nelems, memory_order_relaxed) <= 0) return false;
+
+    struct heap *a = &mq->heaps[random_heap(mq)];
+    struct heap *b = &mq->heaps[random_heap(mq)];
+
+    // Only ever trylock while holding another lock, so there is no lock order to respect
+    if (pthread_mutex_trylock(&a->lock) != 0) continue;
+    if (b != a && pthread_mutex_trylock(&b->lock) != 0) {
+      pthread_mutex_unlock(&a->lock);
+      continue;
+    }
+
+    const void *top_a = pqueue_top(a->pq);
+    const void *top_b = b != a ? pqueue_top(b->pq) : NULL;
+    struct heap *best = top_a ? a : NULL;
+    if (top_b && (!top_a || mq->cmp(top_b, top_a))) best = b;
+    if (best) pqueue_pop_into(best->pq, dst);
+
+    if (b != a) pthread_mutex_unlock(&b->lock);
+    pthread_mutex_unlock(&a->lock);
+
+    if (best) {
+      atomic_fetch_sub_explicit(&mq->nelems, 1, memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // Few non-empty heaps (or lots of contention): go looking for an element
+  return pop_scan(mq, dst);
+}
+
+int multiqueue_size(const MultiQueue *mq) {
+  int n = atomic_load_explicit(&((MultiQueue *) mq)->nelems, memory_order_relaxed);
+  return n > 0 ? n : 0;
+}
+
+/**
+ * @fn pop_scan
+ * @brief Pops the top of the first non-empty heap, starting at a random one
+ * @return True if an element was popped, false if every heap was empty
+ */
+static bool pop_scan(MultiQueue *mq, void *dst) {
+  unsigned int start = random_heap(mq);
+  for (int i = 0; i < mq->nheaps; ++i) {
+    struct heap *h = &mq->heaps[(start + i) % mq->nheaps];
+    pthread_mutex_lock(&h->lock);
+    bool found = !pqueue_empty(h->pq);
+    if (found) pqueue_pop_into(h->pq, dst);
+    pthread_mutex_unlock(&h->lock);
+    if (found) {
+      atomic_fetch_sub_explicit(&mq->nelems, 1, memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @fn random_heap
+ * @return Index of a heap chosen uniformly at random using a per-thread xorshift generator
+ */
+static inline unsigned int random_heap(const MultiQueue *mq) {
+  static _Thread_local uint64_t state = 0;
+  if (state == 0) {
+    // Each thread takes the next splitmix64 step from a shared counter. Seeding from the address of
+    // state instead lets the compiler fold the constant into a TLS relocation which doesn't fit.
+    static atomic_uint_fast64_t seeds = 0;
+    uint64_t z = atomic_fetch_add_explicit(&seeds, 0x9E3779B97F4A7C15ULL, memory_order_relaxed) +
+                 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    state = (z ^ (z >> 31)) | 1;
+  }
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  uint64_t r = state * 0x2545F4914F6CDD1DULL;
+  return (unsigned int) (((r >> 32) * (uint64_t) mq->nheaps) >> 32);
+}
@@ -0,0 +1,336 @@
+/**
+ * @file pairing_heap.c
+ * @brief Implementation of the pairing heap
+ */
+
+#include "pairing_heap.h"
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+#define FIRST_CHUNK_NODES 64
+#define MAX_CHUNK_NODES 65536
+
+/**
+ * @struct PairingNode
+ * @brief A node in the heap-ordered tree, stored as first child / next sibling.
+ * prev is the parent for a first child and the previous sibling otherwise.
+ */
+struct PairingNode {
+  PHNode *child;
+  PHNode *sibling;
+  PHNode *prev;
+  _Alignas(max_align_t) char data[];
+};
+
+/**
+ * @struct chunk
+ * @brief A block of nodes handed out by the pool
+ */
+struct chunk {
+  struct chunk *next;
+  _Alignas(max_align_t) char nodes[];
+};
+
+/**
+ * @struct pool
+ * @brief Bump allocator over a list of chunks, with a free list of returned nodes
+ */
+struct pool {
+  struct chunk *chunks;
+  struct chunk *last_chunk;
+  char *bump;           // next unused node of the newest chunk
+  char *bump_end;
+  int chunk_nodes;      // number of nodes in the next chunk to allocate
+  PHNode *free_head;    // returned nodes, linked through sibling
+  PHNode *free_tail;
+};
+
+struct PairingHeapImplementation {
+  PHNode *root;
+  int nelems;
+  size_t elemsz;
+  size_t nodesz;
+  Cmp cmp;
+  CleanupElemFn cleanup;
+  struct pool pool;
+};
+
+static PHNode *node_alloc(PairingHeap *ph);
+static void node_free(PairingHeap *ph, PHNode *node);
+static void pool_release(struct pool *pool);
+static PHNode *link(const PairingHeap *ph, PHNode *a, PHNode *b);
+static void cut(PHNode *node);
+static PHNode *combine_siblings(const PairingHeap *ph, PHNode *first);
+static void remove_top(PairingHeap *ph);
+
+PairingHeap *pheap_create(size_t elemsz, Cmp cmp, CleanupElemFn cleanup) {
+  assert(cmp != NULL);
+  PairingHeap *ph = malloc(sizeof(PairingHeap));
+  if (ph == NULL) {
+    perror(__func__);
+    exit(EXIT_FAILURE);
+  }
+
+  ph->root = NULL;
+  ph->nelems = 0;
+  ph->elemsz = elemsz;
+  ph->nodesz = sizeof(PHNode) + elemsz;
+  ph->nodesz = (ph->nodesz + _Alignof(PHNode) - 1) & ~(_Alignof(PHNode) - 1);
+  ph->cmp = cmp;
+  ph->cleanup = cleanup;
+  memset(&ph->pool, 0, sizeof(struct pool));
+  ph->pool.chunk_nodes = FIRST_CHUNK_NODES;
+  return ph;
+}
+
+void pheap_dispose(PairingHeap *ph) {
+  pheap_clear(ph);
+  free(ph);
+}
+
+void pheap_clear(PairingHeap *ph) {
+  if (ph->cleanup) {
+    // Walk the tree as a work list threaded through the sibling pointers
+    PHNode *work = ph->root;
+    while (work) {
+      PHNode *node = work;
+      work = node->sibling;
+      if (node->child) {
+        PHNode *last = node->child;
+        while (last->sibling) last = last->sibling;
+        last->sibling = work;
+        work = node->child;
+      }
+      ph->cleanup(node->data);
+    }
+  }
+
+  pool_release(&ph->pool);
+  ph->root = NULL;
+  ph->nelems = 0;
+}
+
+PHNode *pheap_push(PairingHeap *ph, const void *source) {
+  PHNode *node = node_alloc(ph);
+  node->child = NULL;
+  node->sibling = NULL;
+  node->prev = NULL;
+  memcpy(node->data, source, ph->elemsz);
+
+  ph->root = ph->root ? link(ph, ph->root, node) : node;
+  ph->nelems++;
+  return node;
+}
+
+void *pheap_top(const PairingHeap *ph) {
+  return ph->root ? ph->root->data : NULL;
+}
+
+void pheap_pop(PairingHeap *ph) {
+  assert(ph->root);
+  if (ph->cleanup) ph->cleanup(ph->root->data);
+  remove_top(ph);
+}
+
+void pheap_pop_into(PairingHeap *ph, void *dst) {
+  assert(ph->root);
+  memcpy(dst, ph->root->data, ph->elemsz);
+  remove_top(ph);
+}
+
+void *pheap_get(const PHNode *node) {
+  return (void *) node->data;
+}
+
+void pheap_decrease_key(PairingHeap *ph, PHNode *node) {
+  if (node == ph->root) return;
+  cut(node);
+  ph->root = link(ph, ph->root, node);
+}
+
+void pheap_remove(PairingHeap *ph, PHNode *node) {
+  if (node == ph->root) {
+    pheap_pop(ph);
+    return;
+  }
+
+  cut(node);
+  PHNode *children = combine_siblings(ph, node->child);
+  if (children) ph->root = link(ph, ph->root, children);
+
+  if (ph->cleanup) ph->cleanup(node->data);
+  node_free(ph, node);
+  ph->nelems--;
+}
+
+void pheap_meld(PairingHeap *into, PairingHeap *from) {
+  assert(into->elemsz == from->elemsz);
+  assert(into->cmp == from->cmp);
+  if (into == from) return;
+
+  if (from->root)
+    into->root = into->root ? link(into, into->root, from->root) : from->root;
+  into->nelems += from->nelems;
+
+  // The nodes now belong to into, so their memory has to go with them
+  struct pool *a = &into->pool, *b = &from->pool;
+  if (b->chunks) {
+    if (a->chunks) a->last_chunk->next = b->chunks;
+    else a->chunks = b->chunks;
+    a->last_chunk = b->last_chunk;
+  }
+  if (b->free_head) {
+    if (a->free_head) a->free_tail->sibling = b->free_head;
+    else a->free_head = b->free_head;
+    a->free_tail = b->free_tail;
+  }
+
+  // Whatever is left of from's bump chunk is abandoned until into is disposed
+  memset(b, 0, sizeof(struct pool));
+  b->chunk_nodes = FIRST_CHUNK_NODES;
+  from->root = NULL;
+  from->nelems = 0;
+}
+
+bool pheap_empty(const PairingHeap *ph) {
+  return ph->nelems == 0;
+}
+
+int pheap_size(const PairingHeap *ph) {
+  return ph->nelems;
+}
+
+/**
+ * @fn link
+ * @brief Melds two heap-ordered trees (roots without siblings) by making the
+ * larger root the first child of the smaller one
+ * @return The root of the melded tree
+ */
+static PHNode *link(const PairingHeap *ph, PHNode *a, PHNode *b) {
+  if (ph->cmp(b->data, a->data)) {
+    PHNode *tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  b->sibling = a->child;
+  if (a->child) a->child->prev = b;
+  b->prev = a;
+  a->child = b;
+  a->sibling = NULL;
+  a->prev = NULL;
+  return a;
+}
+
+/**
+ * @fn cut
+ * @brief Detaches a (non-root) node, together with its subtree, from its parent and siblings
+ */
+static void cut(PHNode *node) {
+  if (node->prev->child == node) node->prev->child = node->sibling;
+  else node->prev->sibling = node->sibling;
+  if (node->sibling) node->sibling->prev = node->prev;
+  node->sibling = NULL;
+  node->prev = NULL;
+}
+
+/**
+ * @fn combine_siblings
+ * @brief The two pass pairing: meld siblings in pairs from left to right, then
+ * meld the pairs together from right to left
+ * @param first The first of a list of siblings
+ * @return Root of the resulting tree (NULL if the list was empty)
+ */
+static PHNode *combine_siblings(const PairingHeap *ph, PHNode *first) {
+  if (first == NULL) return NULL;
+
+  // First pass, stacking the melded pairs through the sibling pointers
+  PHNode *stack = NULL;
+  while (first) {
+    PHNode *a = first;
+    PHNode *b = a->sibling;
+    if (b == NULL) {
+      a->prev = NULL;
+      a->sibling = stack;
+      stack = a;
+      break;
+    }
+    first = b->sibling;
+    PHNode *pair = link(ph, a, b);
+    pair->sibling = stack;
+    stack = pair;
+  }
+
+  // Second pass, the top of the stack being the rightmost pair
+  PHNode *root = stack;
+  stack = stack->sibling;
+  root->sibling = NULL;
+  while (stack) {
+    PHNode *next = stack->sibling;
+    stack->sibling = NULL;
+    root = link(ph, root, stack);
+    stack = next;
+  }
+  return root;
+}
+
+/**
+ * @fn remove_top
+ * @brief Removes the root without cleaning it up
+ */
+static void remove_top(PairingHeap *ph) {
+  PHNode *root = ph->root;
+  ph->root = combine_siblings(ph, root->child);
+  node_free(ph, root);
+  ph->nelems--;
+}
+
+static PHNode *node_alloc(PairingHeap *ph) {
+  struct pool *pool = &ph->pool;
+  if (pool->free_head) {
+    PHNode *node = pool->free_head;
+    pool->free_head = node->sibling;
+    if (pool->free_head == NULL) pool->free_tail = NULL;
+    return node;
+  }
+
+  if (pool->bump == pool->bump_end) {
+    struct chunk *chunk = malloc(sizeof(struct chunk) + pool->chunk_nodes * ph->nodesz);
+    if (chunk == NULL) {
+      perror(__func__);
+      exit(EXIT_FAILURE);
+    }
+    chunk->next = NULL;
+    if (pool->chunks) pool->last_chunk->next = chunk;
+    else pool->chunks = chunk;
+    pool->last_chunk = chunk;
+
+    pool->bump = chunk->nodes;
+    pool->bump_end = chunk->nodes + pool->chunk_nodes * ph->nodesz;
+    if (pool->chunk_nodes < MAX_CHUNK_NODES) pool->chunk_nodes *= 2;
+  }
+
+  PHNode *node = (PHNode *) pool->bump;
+  pool->bump += ph->nodesz;
+  return node;
+}
+
+static void node_free(PairingHeap *ph, PHNode *node) {
+  struct pool *pool = &ph->pool;
+  node->sibling = pool->free_head;
+  pool->free_head = node;
+  if (pool->free_tail == NULL) pool->free_tail = node;
+}
+
+static void pool_release(struct pool *pool) {
+  struct chunk *chunk = pool->chunks;
+  while (chunk) {
+    struct chunk *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  memset(pool, 0, sizeof(struct pool));
+  pool->chunk_nodes = FIRST_CHUNK_NODES;
+}
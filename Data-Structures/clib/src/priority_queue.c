@@ -11,51 +11,83 @@
 
 #define DEFAULT_CAPACITY 16
 
+static PriorityQueue *create(size_t elemsz, unsigned int capacity_hint, unsigned int arity,
+                             Cmp cmp, CleanupElemFn cleanup, bool addressable);
 static inline void* el_at(const PriorityQueue *pq, int i);
-static inline void* last_element(const PriorityQueue *pq);
-static inline void* heap_end(const PriorityQueue* pq);
-static inline void swap(PriorityQueue *pq, int i, int j);
-static inline int parent_of(int index);
-static inline int left_of(int index);
-static inline int right_of(int index);
-static void swap_down(PriorityQueue *pq, int index);
-static void swap_up(PriorityQueue *pq, int index);
+static inline void move(PriorityQueue *pq, int to, int from);
+static inline void place(PriorityQueue *pq, int to, const void *source, int slot);
+static inline int parent_of(const PriorityQueue *pq, int index);
+static inline int first_child_of(const PriorityQueue *pq, int index);
+static inline int best_child(const PriorityQueue *pq, int first);
+static void swap_down(PriorityQueue *pq, int hole, const void *source, int slot);
+static void swap_up(PriorityQueue *pq, int hole, const void *source, int slot);
+static void resift(PriorityQueue *pq, int hole, const void *source, int slot);
+static int sift_hole_to_leaf(PriorityQueue *pq, int hole);
+static void remove_top(PriorityQueue *pq);
+static void heapify(PriorityQueue *pq);
+static int new_slot(PriorityQueue *pq);
+static void release_slot(PriorityQueue *pq, int slot);
+static inline PQHandle handle_of_slot(const PriorityQueue *pq, int slot);
+static inline int slot_of(PQHandle handle);
 static void double_size(PriorityQueue *pq);
+static void reserve(PriorityQueue *pq, int capacity);
 static inline bool cmp(const PriorityQueue* pq, int i, int j);
 
 struct PriorityQueueImplementation {
   void* heap;
+  void* scratch;      // holds the element being sifted while its slot is a hole
   int nelems;
   int capacity;
+  int arity;
   size_t elemsz;
   CleanupElemFn cleanup;
   Cmp cmp;
+
+  // Only for addressable queues (NULL otherwise). A handle is the slot of its element
+  // in these arrays, with the generation of the slot in the upper bits. The generation
+  // goes up whenever the slot is freed, so the handles of elements which already left
+  // the queue don't match the slot any more once it is reused.
+  int* slot_of_index;     // heap index -> slot of the element there
+  int* index_of;          // slot -> heap index of its element, or -1 if not in the queue
+  unsigned* generation_of;
+  int* free_slots;
+  int nfree;
+  int nslots;             // number of slots ever used
 };
 
-PriorityQueue *pqueue_create(size_t elemsz, unsigned int capacity_hint, Cmp cmp, CleanupElemFn cleanup) {
-  PriorityQueue* pq = malloc(sizeof(struct PriorityQueueImplementation));
-  if (pq == NULL) {
-    perror(__func__);
-    exit(EXIT_FAILURE);
-  }
+#define SLOT_BITS 32
+#define SLOT_MASK ((PQHandle) 0xFFFFFFFF)
+#define GENERATION_MASK 0x7FFFFFFFu   // keeps handles non-negative
 
-  pq->elemsz = elemsz;
-  pq->cleanup = cleanup;
-  pq->cmp = cmp;
+PriorityQueue *pqueue_create(size_t elemsz, unsigned int capacity_hint, unsigned int arity,
+                             Cmp cmp, CleanupElemFn cleanup) {
+  return create(elemsz, capacity_hint, arity, cmp, cleanup, false);
+}
 
-  pq->capacity = capacity_hint ? capacity_hint : DEFAULT_CAPACITY;
-  pq->heap = malloc(elemsz * pq->capacity);
-  if (pq->heap == NULL) {
-    perror(__func__);
-    exit(EXIT_FAILURE);
-  }
+PriorityQueue *pqueue_create_addressable(size_t elemsz, unsigned int capacity_hint, unsigned int arity,
+                                         Cmp cmp, CleanupElemFn cleanup) {
+  return create(elemsz, capacity_hint, arity, cmp, cleanup, true);
+}
 
+PriorityQueue *pqueue_create_from(const void *array, int n, size_t elemsz, unsigned int arity,
+                                  Cmp cmp, CleanupElemFn cleanup) {
+  assert(n >= 0);
+  PriorityQueue *pq = create(elemsz, (unsigned int) n, arity, cmp, cleanup, false);
+  if (n == 0) return pq;
+  memcpy(pq->heap, array, n * elemsz);
+  pq->nelems = n;
+  heapify(pq);
   return pq;
 }
 
 void pqueue_dispose(PriorityQueue *pq) {
   pqueue_clear(pq);
   free(pq->heap);
+  free(pq->scratch);
+  free(pq->slot_of_index);
+  free(pq->index_of);
+  free(pq->generation_of);
+  free(pq->free_slots);
   free(pq);
 }
 
@@ -67,16 +99,92 @@ void* pqueue_top(const PriorityQueue *pq) {
 void pqueue_pop(PriorityQueue* pq) {
   assert(pq->nelems);
   if (pq->cleanup) pq->cleanup(pq->heap);
-  memcpy(pq->heap, last_element(pq), pq->elemsz);
-  pq->nelems--;
-  swap_down(pq, 0);
+  remove_top(pq);
 }
 
-void pqueue_push(PriorityQueue *pq, const void *source) {
+void pqueue_pop_into(PriorityQueue* pq, void *dst) {
+  assert(pq->nelems);
+  memcpy(dst, pq->heap, pq->elemsz);
+  remove_top(pq);
+}
+
+PQHandle pqueue_push(PriorityQueue *pq, const void *source) {
   if (pq->nelems == pq->capacity) double_size(pq);
-  memcpy(heap_end(pq), source, pq->elemsz);
+  int slot = pq->index_of ? new_slot(pq) : -1;
   pq->nelems++;
-  swap_up(pq, pq->nelems - 1);
+  swap_up(pq, pq->nelems - 1, source, slot);
+  return pq->index_of ? handle_of_slot(pq, slot) : PQ_NO_HANDLE;
+}
+
+void pqueue_push_many(PriorityQueue *pq, const void *source, int n, PQHandle *handles) {
+  assert(n >= 0);
+  if (n == 0) return;
+  reserve(pq, pq->nelems + n);
+
+  int first = pq->nelems;
+  memcpy(el_at(pq, first), source, n * pq->elemsz);
+  pq->nelems += n;
+
+  if (pq->index_of) {
+    for (int i = first; i < pq->nelems; ++i) {
+      int slot = new_slot(pq);
+      pq->slot_of_index[i] = slot;
+      pq->index_of[slot] = i;
+      if (handles) handles[i - first] = handle_of_slot(pq, slot);
+    }
+  } else if (handles) {
+    for (int i = 0; i < n; ++i) handles[i] = PQ_NO_HANDLE;
+  }
+
+  // n pushes cost about n * depth moves where rebuilding is linear in the size of the
+  // heap, so rebuild if the batch is big enough to make up for the existing elements
+  int depth = 0;
+  for (int size = pq->nelems; size > 1; size /= pq->arity) depth++;
+  if ((long) n * depth >= pq->nelems) {
+    heapify(pq);
+    return;
+  }
+
+  // Sifting up only looks at ancestors, so the unsifted elements behind don't matter
+  for (int i = first; i < pq->nelems; ++i) {
+    memcpy(pq->scratch, el_at(pq, i), pq->elemsz);
+    swap_up(pq, i, pq->scratch, pq->index_of ? pq->slot_of_index[i] : -1);
+  }
+}
+
+bool pqueue_contains(const PriorityQueue *pq, PQHandle handle) {
+  assert(pq->index_of);
+  if (handle < 0) return false;
+  int slot = slot_of(handle);
+  if (slot >= pq->nslots) return false;
+  return handle_of_slot(pq, slot) == handle && pq->index_of[slot] >= 0;
+}
+
+void* pqueue_get(const PriorityQueue *pq, PQHandle handle) {
+  assert(pqueue_contains(pq, handle));
+  return el_at(pq, pq->index_of[slot_of(handle)]);
+}
+
+void pqueue_update(PriorityQueue *pq, PQHandle handle) {
+  assert(pqueue_contains(pq, handle));
+  int slot = slot_of(handle);
+  int index = pq->index_of[slot];
+  memcpy(pq->scratch, el_at(pq, index), pq->elemsz);
+  resift(pq, index, pq->scratch, slot);
+}
+
+void pqueue_remove(PriorityQueue *pq, PQHandle handle) {
+  assert(pqueue_contains(pq, handle));
+  int slot = slot_of(handle);
+  int index = pq->index_of[slot];
+  if (pq->cleanup) pq->cleanup(el_at(pq, index));
+  release_slot(pq, slot);
+  pq->nelems--;
+  if (index == pq->nelems) return; // it was the last element
+
+  // Fill the hole with the last element, which may belong above or below it
+  memcpy(pq->scratch, el_at(pq, pq->nelems), pq->elemsz);
+  resift(pq, index, pq->scratch, pq->slot_of_index[pq->nelems]);
 }
 
 bool pqueue_empty(const PriorityQueue *pq) {
@@ -87,36 +195,181 @@ int pqueue_size(const PriorityQueue *pq) {
   return pq->nelems;
 }
 
-static void swap_down(PriorityQueue *pq, int index) {
-  int left = left_of(index);
-  int right = right_of(index);
+static PriorityQueue *create(size_t elemsz, unsigned int capacity_hint, unsigned int arity,
+                             Cmp cmp, CleanupElemFn cleanup, bool addressable) {
+  PriorityQueue* pq = malloc(sizeof(struct PriorityQueueImplementation));
+  if (pq == NULL) {
+    perror(__func__);
+    exit(EXIT_FAILURE);
+  }
 
-  if (left >= pq->nelems) return; // has no children
-  bool has_right = right < pq->nelems;
+  pq->elemsz = elemsz;
+  pq->cleanup = cleanup;
+  pq->cmp = cmp;
+  pq->nelems = 0;
+  pq->arity = arity >= 2 ? (int) arity : PQUEUE_DEFAULT_ARITY;
 
-  if (cmp(pq, left, index) && has_right && cmp(pq, left, right)) {
-    swap(pq, left, index);
-    swap_down(pq, left);
-  } else if (has_right && cmp(pq, right, index) && cmp(pq, right, left)) {
-    swap(pq, right, index);
-    swap_down(pq, right);
+  pq->capacity = capacity_hint ? capacity_hint : DEFAULT_CAPACITY;
+  pq->heap = malloc(elemsz * pq->capacity);
+  pq->scratch = malloc(elemsz);
+  if (pq->heap == NULL || pq->scratch == NULL) {
+    perror(__func__);
+    exit(EXIT_FAILURE);
   }
+
+  pq->slot_of_index = NULL;
+  pq->index_of = NULL;
+  pq->generation_of = NULL;
+  pq->free_slots = NULL;
+  pq->nfree = 0;
+  pq->nslots = 0;
+  if (addressable) {
+    // There are never more slots in use than elements, so capacity bounds all of them
+    pq->slot_of_index = malloc(pq->capacity * sizeof(int));
+    pq->index_of = malloc(pq->capacity * sizeof(int));
+    pq->generation_of = malloc(pq->capacity * sizeof(unsigned));
+    pq->free_slots = malloc(pq->capacity * sizeof(int));
+    if (pq->slot_of_index == NULL || pq->index_of == NULL || pq->generation_of == NULL || pq->free_slots == NULL) {
+      perror(__func__);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  return pq;
+}
+
+/**
+ * @fn swap_down
+ * @brief Fills the hole at index with source, moving smaller children up into the
+ * hole until source is no greater than all of the children of the hole
+ */
+static void swap_down(PriorityQueue *pq, int hole, const void *source, int slot) {
+  for (int first = first_child_of(pq, hole); first < pq->nelems; first = first_child_of(pq, hole)) {
+    int child = best_child(pq, first);
+    if (!pq->cmp(el_at(pq, child), source)) break;
+    move(pq, hole, child);
+    hole = child;
+  }
+  place(pq, hole, source, slot);
 }
 
-static void swap_up(PriorityQueue *pq, int index) {
-  if (index == 0) return;
-  int parent = parent_of(index);
-  if (cmp(pq, index, parent)) {
-    swap(pq, parent, index);
-    swap_up(pq, parent);
+/**
+ * @fn swap_up
+ * @brief Fills the hole at index with source, moving larger parents down into the
+ * hole until source is no less than the parent of the hole
+ */
+static void swap_up(PriorityQueue *pq, int hole, const void *source, int slot) {
+  while (hole > 0) {
+    int parent = parent_of(pq, hole);
+    if (!pq->cmp(source, el_at(pq, parent))) break;
+    move(pq, hole, parent);
+    hole = parent;
   }
+  place(pq, hole, source, slot);
 }
 
-static inline void swap(PriorityQueue *pq, int i, int j) {
-  char tmp[pq->elemsz];
-  memcpy(tmp, el_at(pq, i), pq->elemsz);
-  memcpy(el_at(pq, i), el_at(pq, j), pq->elemsz);
-  memcpy(el_at(pq, j), tmp, pq->elemsz);
+/**
+ * @fn resift
+ * @brief Fills the hole at index with source, sifting whichever direction it needs to go
+ */
+static void resift(PriorityQueue *pq, int hole, const void *source, int slot) {
+  if (hole > 0 && pq->cmp(source, el_at(pq, parent_of(pq, hole))))
+    swap_up(pq, hole, source, slot);
+  else
+    swap_down(pq, hole, source, slot);
+}
+
+/**
+ * @fn sift_hole_to_leaf
+ * @brief Moves the smallest child into the hole on every level until the hole is a leaf
+ * @return The index of the leaf where the hole ended up
+ */
+static int sift_hole_to_leaf(PriorityQueue *pq, int hole) {
+  for (int first = first_child_of(pq, hole); first < pq->nelems; first = first_child_of(pq, hole)) {
+    int child = best_child(pq, first);
+    move(pq, hole, child);
+    hole = child;
+  }
+  return hole;
+}
+
+/**
+ * @fn remove_top
+ * @brief Removes the top element without cleaning it up
+ */
+static void remove_top(PriorityQueue *pq) {
+  if (pq->index_of) release_slot(pq, pq->slot_of_index[0]);
+  pq->nelems--;
+  if (pq->nelems == 0) return;
+
+  // Floyd: carry the hole at the root down to a leaf without looking at the
+  // last element, then let the last element rise from there
+  memcpy(pq->scratch, el_at(pq, pq->nelems), pq->elemsz);
+  int last = pq->index_of ? pq->slot_of_index[pq->nelems] : -1;
+  int leaf = sift_hole_to_leaf(pq, 0);
+  swap_up(pq, leaf, pq->scratch, last);
+}
+
+/**
+ * @fn heapify
+ * @brief Floyd's O(n) heap construction: sift down every internal node, from the last one up to the root
+ */
+static void heapify(PriorityQueue *pq) {
+  for (int i = parent_of(pq, pq->nelems - 1); i >= 0; --i) {
+    memcpy(pq->scratch, el_at(pq, i), pq->elemsz);
+    swap_down(pq, i, pq->scratch, pq->index_of ? pq->slot_of_index[i] : -1);
+  }
+}
+
+/**
+ * @fn best_child
+ * @param first Index of the first child of a node (which must exist)
+ * @return Index of the smallest of the children starting at first
+ */
+static inline int best_child(const PriorityQueue *pq, int first) {
+  int last = first + pq->arity;
+  if (last > pq->nelems) last = pq->nelems;
+  int best = first;
+  for (int i = first + 1; i < last; ++i)
+    if (cmp(pq, i, best)) best = i;
+  return best;
+}
+
+static inline void move(PriorityQueue *pq, int to, int from) {
+  memcpy(el_at(pq, to), el_at(pq, from), pq->elemsz);
+  if (pq->index_of) {
+    int slot = pq->slot_of_index[from];
+    pq->slot_of_index[to] = slot;
+    pq->index_of[slot] = to;
+  }
+}
+
+static inline void place(PriorityQueue *pq, int to, const void *source, int slot) {
+  memcpy(el_at(pq, to), source, pq->elemsz);
+  if (pq->index_of) {
+    pq->slot_of_index[to] = slot;
+    pq->index_of[slot] = to;
+  }
+}
+
+static int new_slot(PriorityQueue *pq) {
+  if (pq->nfree) return pq->free_slots[--pq->nfree];
+  pq->generation_of[pq->nslots] = 0;
+  return pq->nslots++;
+}
+
+static void release_slot(PriorityQueue *pq, int slot) {
+  pq->index_of[slot] = -1;
+  pq->generation_of[slot] = (pq->generation_of[slot] + 1) & GENERATION_MASK;
+  pq->free_slots[pq->nfree++] = slot;
+}
+
+static inline PQHandle handle_of_slot(const PriorityQueue *pq, int slot) {
+  return ((PQHandle) pq->generation_of[slot] << SLOT_BITS) | slot;
+}
+
+static inline int slot_of(PQHandle handle) {
+  return (int) (handle & SLOT_MASK);
 }
 
 static void double_size(PriorityQueue *pq) {
@@ -126,14 +379,21 @@ static void double_size(PriorityQueue *pq) {
     perror(__func__);
     exit(EXIT_FAILURE);
   }
-}
 
-static inline void* last_element(const PriorityQueue *pq) {
-  return el_at(pq, pq->nelems - 1);
+  if (pq->index_of) {
+    pq->slot_of_index = realloc(pq->slot_of_index, pq->capacity * sizeof(int));
+    pq->index_of = realloc(pq->index_of, pq->capacity * sizeof(int));
+    pq->generation_of = realloc(pq->generation_of, pq->capacity * sizeof(unsigned));
+    pq->free_slots = realloc(pq->free_slots, pq->capacity * sizeof(int));
+    if (!pq->slot_of_index || !pq->index_of || !pq->generation_of || !pq->free_slots) {
+      perror(__func__);
+      exit(EXIT_FAILURE);
+    }
+  }
 }
 
-static inline void* heap_end(const PriorityQueue* pq) {
-  return el_at(pq, pq->nelems);
+static void reserve(PriorityQueue *pq, int capacity) {
+  while (pq->capacity < capacity) double_size(pq);
 }
 
 static inline bool cmp(const PriorityQueue* pq, int i, int j) {
@@ -147,6 +407,10 @@ void pqueue_clear(PriorityQueue* pq) {
       pq->cleanup(el);
     }
   }
+  // Free the slots of the elements one by one, so that their handles go stale too
+  if (pq->index_of) {
+    for (int i = 0; i < pq->nelems; ++i) release_slot(pq, pq->slot_of_index[i]);
+  }
   pq->nelems = 0;
 }
 
@@ -154,12 +418,10 @@ static inline void* el_at(const PriorityQueue *pq, int i) {
   return (char*) pq->heap + i * pq->elemsz;
 }
 
-static inline int parent_of(int index) {
-  return (index + 1) / 2 - 1;
-}
-static inline int left_of(int index) {
-  return 2 * (index + 1) - 1;
+static inline int parent_of(const PriorityQueue *pq, int index) {
+  return (index - 1) / pq->arity;
 }
-static inline int right_of(int index) {
-  return 1 + left_of(index);
+
+static inline int first_child_of(const PriorityQueue *pq, int index) {
+  return pq->arity * index + 1;
 }
@@ -0,0 +1,198 @@
+/**
+ * @file spsc_ring.c
+ * @brief Implementation of the single-producer single-consumer ring buffer
+ */
+
+#include "spsc_ring.h"
+#include <string.h>
+#include <assert.h>
+
+/**
+ * @struct SPSCRingImplementation
+ * @details Indices are free running and wrapped with mask when used. Each group of
+ * fields which is written by only one side sits on its own cache line.
+ */
+struct SPSCRingImplementation {
+  _Alignas(CACHE_LINE_SIZE) atomic_size_t head;   // Next element to read (written by consumer)
+  _Alignas(CACHE_LINE_SIZE) atomic_size_t tail;   // End of published elements (written by producer)
+
+  _Alignas(CACHE_LINE_SIZE) size_t write;         // Producer: next slot to stage into
+  size_t cached_head;                             // Producer: last head that was read
+
+  _Alignas(CACHE_LINE_SIZE) size_t cached_tail;   // Consumer: last tail that was read
+
+  _Alignas(CACHE_LINE_SIZE) char *buffer;
+  size_t mask;
+  size_t elem_size;
+  WaitStrategy wait;
+  CleanupElemFn cleanup;
+
+  Waiter not_empty;
+  Waiter not_full;
+};
+
+static size_t free_slots(SPSCRing *r, size_t wanted);
+static size_t available(SPSCRing *r, size_t wanted);
+static void copy_in(SPSCRing *r, size_t pos, const void *src, size_t n);
+static void copy_out(const SPSCRing *r, size_t pos, void *dst, size_t n);
+static inline void *el_at(const SPSCRing *r, size_t pos);
+static bool try_push_op(void *r, void *data);
+static bool try_pop_op(void *r, void *dst);
+
+SPSCRing *spsc_create(size_t elem_size, unsigned int capacity, WaitStrategy wait, CleanupElemFn cleanup) {
+  if (elem_size == 0 || capacity == 0) return NULL;
+
+  size_t nslots = 1;
+  while (nslots < capacity) nslots <<= 1;
+
+  size_t size = (sizeof(SPSCRing) + CACHE_LINE_SIZE - 1) & ~((size_t) CACHE_LINE_SIZE - 1);
+  SPSCRing *r = aligned_alloc(CACHE_LINE_SIZE, size);
+  if (r == NULL) return NULL;
+
+  r->buffer = malloc(nslots * elem_size);
+  if (r->buffer == NULL) {
+    free(r);
+    return NULL;
+  }
+
+  atomic_init(&r->head, 0);
+  atomic_init(&r->tail, 0);
+  r->write = 0;
+  r->cached_head = 0;
+  r->cached_tail = 0;
+  r->mask = nslots - 1;
+  r->elem_size = elem_size;
+  r->wait = wait;
+  r->cleanup = cleanup;
+
+  waiter_init(&r->not_empty);
+  waiter_init(&r->not_full);
+  return r;
+}
+
+void spsc_dispose(SPSCRing *r) {
+  assert(r != NULL);
+  if (r->cleanup) {
+    for (size_t pos = atomic_load(&r->head); pos != r->write; ++pos)
+      r->cleanup(el_at(r, pos));
+  }
+  waiter_destroy(&r->not_empty);
+  waiter_destroy(&r->not_full);
+  free(r->buffer);
+  free(r);
+}
+
+bool spsc_stage(SPSCRing *r, const void *data) {
+  if (free_slots(r, 1) == 0) return false;
+  memcpy(el_at(r, r->write), data, r->elem_size);
+  r->write++;
+  return true;
+}
+
+void spsc_publish(SPSCRing *r) {
+  atomic_store_explicit(&r->tail, r->write, memory_order_release);
+  if (r->wait == WAIT_BLOCK) waiter_notify(&r->not_empty);
+}
+
+bool spsc_try_push(SPSCRing *r, const void *data) {
+  if (!spsc_stage(r, data)) return false;
+  spsc_publish(r);
+  return true;
+}
+
+unsigned int spsc_try_push_many(SPSCRing *r, const void *src, unsigned int n) {
+  size_t count = free_slots(r, n);
+  if (count > n) count = n;
+  if (count == 0) return 0;
+
+  copy_in(r, r->write, src, count);
+  r->write += count;
+  spsc_publish(r);
+  return (unsigned int) count;
+}
+
+bool spsc_try_pop(SPSCRing *r, void *dst) {
+  return spsc_try_pop_many(r, dst, 1) == 1;
+}
+
+unsigned int spsc_try_pop_many(SPSCRing *r, void *dst, unsigned int n) {
+  size_t count = available(r, n);
+  if (count > n) count = n;
+  if (count == 0) return 0;
+
+  size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+  copy_out(r, head, dst, count);
+  atomic_store_explicit(&r->head, head + count, memory_order_release);
+  if (r->wait == WAIT_BLOCK) waiter_notify(&r->not_full);
+  return (unsigned int) count;
+}
+
+void spsc_push(SPSCRing *r, const void *data) {
+  waiter_run(&r->not_full, r->wait, try_push_op, r, (void *) data);
+}
+
+void spsc_pop(SPSCRing *r, void *dst) {
+  waiter_run(&r->not_empty, r->wait, try_pop_op, r, dst);
+}
+
+unsigned int spsc_capacity(const SPSCRing *r) {
+  return (unsigned int) (r->mask + 1);
+}
+
+/**
+ * @fn free_slots
+ * @brief Producer side. Number of slots which may be staged into, only
+ * re-reading the consumer's index if the cached one doesn't leave enough room.
+ */
+static size_t free_slots(SPSCRing *r, size_t wanted) {
+  size_t capacity = r->mask + 1;
+  size_t slots = capacity - (r->write - r->cached_head);
+  if (slots < wanted) {
+    r->cached_head = atomic_load_explicit(&r->head, memory_order_acquire);
+    slots = capacity - (r->write - r->cached_head);
+  }
+  return slots;
+}
+
+/**
+ * @fn available
+ * @brief Consumer side. Number of published elements which may be popped, only
+ * re-reading the producer's index if the cached one doesn't have enough.
+ */
+static size_t available(SPSCRing *r, size_t wanted) {
+  size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+  size_t count = r->cached_tail - head;
+  if (count < wanted) {
+    r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    count = r->cached_tail - head;
+  }
+  return count;
+}
+
+static void copy_in(SPSCRing *r, size_t pos, const void *src, size_t n) {
+  size_t offset = pos & r->mask;
+  size_t first = r->mask + 1 - offset;
+  if (first > n) first = n;
+  memcpy(el_at(r, offset), src, first * r->elem_size);
+  memcpy(r->buffer, (const char *) src + first * r->elem_size, (n - first) * r->elem_size);
+}
+
+static void copy_out(const SPSCRing *r, size_t pos, void *dst, size_t n) {
+  size_t offset = pos & r->mask;
+  size_t first = r->mask + 1 - offset;
+  if (first > n) first = n;
+  memcpy(dst, el_at(r, offset), first * r->elem_size);
+  memcpy((char *) dst + first * r->elem_size, r->buffer, (n - first) * r->elem_size);
+}
+
+static inline void *el_at(const SPSCRing *r, size_t pos) {
+  return r->buffer + (pos & r->mask) * r->elem_size;
+}
+
+static bool try_push_op(void *r, void *data) {
+  return spsc_try_push(r, data);
+}
+
+static bool try_pop_op(void *r, void *dst) {
+  return spsc_try_pop(r, dst);
+}
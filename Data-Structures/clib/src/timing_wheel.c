@@ -0,0 +1,359 @@
+/**
+ * @file timing_wheel.c
+ * @brief Implementation of the hierarchical timing wheel
+ */
+
+#include "timing_wheel.h"
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+#define LEVELS 4
+#define SLOT_BITS 8
+#define SLOTS (1 << SLOT_BITS)
+#define SLOT_MASK (SLOTS - 1)
+#define WHEEL_RANGE ((uint64_t) 1 << (LEVELS * SLOT_BITS))    // ticks covered by the wheels
+#define TOP_LEVEL_TICKS ((uint64_t) 1 << ((LEVELS - 1) * SLOT_BITS))
+
+#define BATCH 256               // expired elements per callback
+#define CHUNK_TIMERS 1024       // timers allocated at a time
+
+/**
+ * @struct link
+ * @brief Links of a circular doubly linked list. Each slot is the sentinel of a list of timers.
+ */
+struct link {
+  struct link *next;
+  struct link *prev;
+};
+
+struct TimerImplementation {
+  struct link link;     // must be first: slots link timers through here
+  uint64_t expires;
+  int level;            // wheel the timer is in
+  PQHandle overflow;    // handle in the overflow queue, or PQ_NO_HANDLE if in a wheel
+  _Alignas(max_align_t) char data[];
+};
+
+/**
+ * @struct overflow_entry
+ * @brief Element of the overflow queue
+ */
+struct overflow_entry {
+  uint64_t expires;
+  Timer *timer;
+};
+
+struct chunk {
+  struct chunk *next;
+  _Alignas(max_align_t) char timers[];
+};
+
+struct TimingWheelImplementation {
+  struct link slots[LEVELS][SLOTS];
+  int level_count[LEVELS];    // timers in each wheel
+  uint64_t now;
+  int count;                  // pending timers, including those in overflow
+  PriorityQueue *overflow;
+
+  size_t elemsz;
+  size_t timersz;
+  TimerExpireFn expire;
+  void *arg;
+  CleanupElemFn cleanup;
+
+  char *batch;                // expired elements waiting to be handed to expire
+  int nbatch;
+
+  struct chunk *chunks;
+  Timer *free_timers;         // linked through link.next
+};
+
+static void place(TimingWheel *tw, Timer *timer, uint64_t base);
+static void cascade(TimingWheel *tw, int level, int slot, uint64_t t);
+static void pull_overflow(TimingWheel *tw, uint64_t t);
+static void expire_slot(TimingWheel *tw, int slot, uint64_t t);
+static void flush(TimingWheel *tw);
+static Timer *timer_alloc(TimingWheel *tw);
+static void timer_free(TimingWheel *tw, Timer *timer);
+static inline void list_init(struct link *list);
+static inline bool list_empty(const struct link *list);
+static inline void list_append(struct link *list, struct link *link);
+static inline void list_unlink(struct link *link);
+static void list_take(struct link *to, struct link *from);
+static bool cmp_expires(const void *a, const void *b);
+
+TimingWheel *twheel_create(size_t elemsz, uint64_t now, TimerExpireFn expire, void *arg,
+                           CleanupElemFn cleanup) {
+  assert(expire != NULL);
+  TimingWheel *tw = malloc(sizeof(TimingWheel));
+  if (tw == NULL) {
+    perror(__func__);
+    exit(EXIT_FAILURE);
+  }
+
+  for (int level = 0; level < LEVELS; ++level) {
+    for (int slot = 0; slot < SLOTS; ++slot)
+      list_init(&tw->slots[level][slot]);
+    tw->level_count[level] = 0;
+  }
+
+  tw->now = now;
+  tw->count = 0;
+  tw->overflow = pqueue_create_addressable(sizeof(struct overflow_entry), 0, 0, cmp_expires, NULL);
+
+  tw->elemsz = elemsz;
+  tw->timersz = sizeof(Timer) + elemsz;
+  tw->timersz = (tw->timersz + _Alignof(Timer) - 1) & ~(_Alignof(Timer) - 1);
+  tw->expire = expire;
+  tw->arg = arg;
+  tw->cleanup = cleanup;
+
+  tw->batch = malloc(BATCH * elemsz);
+  if (tw->batch == NULL) {
+    perror(__func__);
+    exit(EXIT_FAILURE);
+  }
+  tw->nbatch = 0;
+  tw->chunks = NULL;
+  tw->free_timers = NULL;
+  return tw;
+}
+
+void twheel_dispose(TimingWheel *tw) {
+  if (tw->cleanup) {
+    for (int level = 0; level < LEVELS; ++level) {
+      for (int slot = 0; slot < SLOTS; ++slot) {
+        struct link *list = &tw->slots[level][slot];
+        for (struct link *link = list->next; link != list; link = link->next)
+          tw->cleanup(((Timer *) link)->data);
+      }
+    }
+    struct overflow_entry entry;
+    while (!pqueue_empty(tw->overflow)) {
+      pqueue_pop_into(tw->overflow, &entry);
+      tw->cleanup(entry.timer->data);
+    }
+  }
+
+  struct chunk *chunk = tw->chunks;
+  while (chunk) {
+    struct chunk *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  pqueue_dispose(tw->overflow);
+  free(tw->batch);
+  free(tw);
+}
+
+Timer *twheel_insert(TimingWheel *tw, uint64_t expires, const void *data) {
+  Timer *timer = timer_alloc(tw);
+  timer->expires = expires > tw->now ? expires : tw->now + 1;
+  memcpy(timer->data, data, tw->elemsz);
+  place(tw, timer, tw->now);
+  tw->count++;
+  return timer;
+}
+
+void twheel_cancel(TimingWheel *tw, Timer *timer) {
+  if (timer->overflow != PQ_NO_HANDLE) pqueue_remove(tw->overflow, timer->overflow);
+  else {
+    list_unlink(&timer->link);
+    tw->level_count[timer->level]--;
+  }
+  if (tw->cleanup) tw->cleanup(timer->data);
+  timer_free(tw, timer);
+  tw->count--;
+}
+
+void twheel_advance(TimingWheel *tw, uint64_t now) {
+  while (tw->now < now) {
+    if (tw->count == 0) {
+      tw->now = now;
+      break;
+    }
+
+    // Nothing happens before the wheel of the finest pending timer moves down a slot
+    int level = 0;
+    while (level < LEVELS - 1 && tw->level_count[level] == 0) level++;
+    if (level > 0) {
+      uint64_t span = (uint64_t) 1 << (level * SLOT_BITS);
+      uint64_t next = (tw->now | (span - 1)) + 1;
+      if (next > now) {
+        tw->now = now;
+        break;
+      }
+      tw->now = next - 1;
+    }
+
+    uint64_t t = ++tw->now;
+
+    // When a wheel wraps around, the next slot of the wheel above moves down
+    for (int level = 1; level < LEVELS; ++level) {
+      int shift = level * SLOT_BITS;
+      if (t & (((uint64_t) 1 << shift) - 1)) break;
+      cascade(tw, level, (int) ((t >> shift) & SLOT_MASK), t);
+      if (level == LEVELS - 1) pull_overflow(tw, t);
+    }
+
+    expire_slot(tw, (int) (t & SLOT_MASK), t);
+  }
+}
+
+uint64_t twheel_now(const TimingWheel *tw) {
+  return tw->now;
+}
+
+int twheel_count(const TimingWheel *tw) {
+  return tw->count;
+}
+
+/**
+ * @fn place
+ * @brief Puts a timer into the slot of the coarsest wheel it needs given the time base,
+ * or into the overflow queue if it is out of reach of the wheels
+ */
+static void place(TimingWheel *tw, Timer *timer, uint64_t base) {
+  assert(timer->expires >= base);
+  uint64_t delta = timer->expires - base;
+  if (delta >= WHEEL_RANGE) {
+    struct overflow_entry entry = { timer->expires, timer };
+    timer->overflow = pqueue_push(tw->overflow, &entry);
+    return;
+  }
+
+  int level = 0;
+  while (delta >= (uint64_t) 1 << ((level + 1) * SLOT_BITS)) level++;
+  int slot = (int) ((timer->expires >> (level * SLOT_BITS)) & SLOT_MASK);
+  timer->level = level;
+  timer->overflow = PQ_NO_HANDLE;
+  list_append(&tw->slots[level][slot], &timer->link);
+  tw->level_count[level]++;
+}
+
+/**
+ * @fn cascade
+ * @brief Redistributes the timers of one slot of a coarse wheel into finer wheels
+ */
+static void cascade(TimingWheel *tw, int level, int slot, uint64_t t) {
+  struct link pending;
+  list_take(&pending, &tw->slots[level][slot]);
+  while (!list_empty(&pending)) {
+    Timer *timer = (Timer *) pending.next;
+    list_unlink(&timer->link);
+    tw->level_count[level]--;
+    place(tw, timer, t);
+  }
+}
+
+/**
+ * @fn pull_overflow
+ * @brief Moves the timers which came within reach of the wheels out of the overflow queue
+ */
+static void pull_overflow(TimingWheel *tw, uint64_t t) {
+  struct overflow_entry entry;
+  while (!pqueue_empty(tw->overflow)) {
+    const struct overflow_entry *top = pqueue_top(tw->overflow);
+    if (top->expires - t >= WHEEL_RANGE) break;
+    pqueue_pop_into(tw->overflow, &entry);
+    place(tw, entry.timer, t);
+  }
+}
+
+/**
+ * @fn expire_slot
+ * @brief Expires all timers in a slot of the finest wheel, which are all due at tick t
+ */
+static void expire_slot(TimingWheel *tw, int slot, uint64_t t) {
+  if (list_empty(&tw->slots[0][slot])) return;
+
+  // Detach the list first, so the callback can insert and cancel freely
+  struct link due;
+  list_take(&due, &tw->slots[0][slot]);
+  while (!list_empty(&due)) {
+    Timer *timer = (Timer *) due.next;
+    list_unlink(&timer->link);
+    tw->level_count[0]--;
+    assert(timer->expires == t);
+
+    memcpy(tw->batch + tw->nbatch * tw->elemsz, timer->data, tw->elemsz);
+    tw->nbatch++;
+    timer_free(tw, timer);
+    tw->count--;
+    if (tw->nbatch == BATCH) flush(tw);
+  }
+  flush(tw);
+}
+
+static void flush(TimingWheel *tw) {
+  int n = tw->nbatch;
+  if (n == 0) return;
+  tw->nbatch = 0;
+  tw->expire(tw->batch, n, tw->arg);
+}
+
+static Timer *timer_alloc(TimingWheel *tw) {
+  if (tw->free_timers == NULL) {
+    struct chunk *chunk = malloc(sizeof(struct chunk) + CHUNK_TIMERS * tw->timersz);
+    if (chunk == NULL) {
+      perror(__func__);
+      exit(EXIT_FAILURE);
+    }
+    chunk->next = tw->chunks;
+    tw->chunks = chunk;
+    for (int i = CHUNK_TIMERS - 1; i >= 0; --i)
+      timer_free(tw, (Timer *) (chunk->timers + i * tw->timersz));
+  }
+
+  Timer *timer = tw->free_timers;
+  tw->free_timers = (Timer *) timer->link.next;
+  return timer;
+}
+
+static void timer_free(TimingWheel *tw, Timer *timer) {
+  timer->link.next = (struct link *) tw->free_timers;
+  tw->free_timers = timer;
+}
+
+static inline void list_init(struct link *list) {
+  list->next = list;
+  list->prev = list;
+}
+
+static inline bool list_empty(const struct link *list) {
+  return list->next == list;
+}
+
+static inline void list_append(struct link *list, struct link *link) {
+  link->prev = list->prev;
+  link->next = list;
+  list->prev->next = link;
+  list->prev = link;
+}
+
+static inline void list_unlink(struct link *link) {
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+}
+
+/**
+ * @fn list_take
+ * @brief Moves all links of one list into another (empty, uninitialized) list
+ */
+static void list_take(struct link *to, struct link *from) {
+  if (list_empty(from)) {
+    list_init(to);
+    return;
+  }
+  to->next = from->next;
+  to->prev = from->prev;
+  to->next->prev = to;
+  to->prev->next = to;
+  list_init(from);
+}
+
+static bool cmp_expires(const void *a, const void *b) {
+  return ((const struct overflow_entry *) a)->expires < ((const struct overflow_entry *) b)->expires;
+}
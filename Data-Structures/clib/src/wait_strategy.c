@@ -0,0 +1,57 @@
+/**
+ * @file wait_strategy.c
+ * @brief Implementation of the queue wait strategies
+ */
+
+#include "wait_strategy.h"
+
+// Number of failed attempts before spinning gives the CPU away or blocking goes to sleep
+#define SPIN_LIMIT 1024
+
+void waiter_init(Waiter *w) {
+  pthread_mutex_init(&w->lock, NULL);
+  pthread_cond_init(&w->cond, NULL);
+  atomic_init(&w->epoch, 0);
+  atomic_init(&w->sleepers, 0);
+}
+
+void waiter_destroy(Waiter *w) {
+  pthread_cond_destroy(&w->cond);
+  pthread_mutex_destroy(&w->lock);
+}
+
+void waiter_run(Waiter *w, WaitStrategy strategy, TryOpFn op, void *queue, void *elem) {
+  // The count stops at SPIN_LIMIT, so spinning forever doesn't overflow it
+  for (int spins = 0; strategy == WAIT_SPIN || spins < SPIN_LIMIT;) {
+    if (op(queue, elem)) return;
+    if (spins < SPIN_LIMIT) {
+      cpu_relax();
+      spins++;
+    } else sched_yield(); // don't starve the thread we're waiting on
+  }
+
+  for (;;) {
+    unsigned int epoch = atomic_load(&w->epoch);
+    if (op(queue, elem)) return;
+
+    // Announce ourselves before checking the epoch so that a notifier which
+    // finished its operation after our attempt either bumps the epoch before
+    // we look at it, or sees us sleeping and wakes us up
+    pthread_mutex_lock(&w->lock);
+    atomic_fetch_add(&w->sleepers, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (atomic_load(&w->epoch) == epoch)
+      pthread_cond_wait(&w->cond, &w->lock);
+    atomic_fetch_sub(&w->sleepers, 1);
+    pthread_mutex_unlock(&w->lock);
+  }
+}
+
+void waiter_notify(Waiter *w) {
+  atomic_fetch_add(&w->epoch, 1);
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&w->sleepers, memory_order_relaxed) == 0) return;
+  pthread_mutex_lock(&w->lock);
+  pthread_cond_broadcast(&w->cond);
+  pthread_mutex_unlock(&w->lock);
+}
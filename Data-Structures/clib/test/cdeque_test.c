@@ -0,0 +1,95 @@
+
+#include "cdeque.h"
+#include <stdio.h>
+#include <assert.h>
+#include <limits.h>
+
+#define BIG 10000
+
+#define FOR(N) for (int i = 0; i < N; ++i)
+
+static int cleanups = 0;
+static void count_cleanup(void *el) {
+  (void) el;
+  cleanups++;
+}
+
+static void assert_contents(const CDeque *dq, int first, int count) {
+  assert(cdeque_count(dq) == count);
+  FOR(count) assert(*(int*) cdeque_at(dq, i) == first + i);
+}
+
+// Grow while the elements wrap around the end of the buffer
+static void test_wrapping_growth() {
+  CDeque *dq = cdeque_create(sizeof(int), 4, NULL);
+  FOR(BIG) {
+    int x = -i - 1;
+    cdeque_push_front(dq, &x);
+    cdeque_push_back(dq, &i);
+  }
+  assert_contents(dq, -BIG, 2 * BIG);
+  assert(*(int*) cdeque_front(dq) == -BIG);
+  assert(*(int*) cdeque_back(dq) == BIG - 1);
+  cdeque_dispose(dq);
+}
+
+// Use as a FIFO queue and as a stack
+static void test_queue_and_stack() {
+  CDeque *dq = cdeque_create(sizeof(int), 0, count_cleanup);
+  FOR(BIG) {
+    cdeque_push_back(dq, &i);
+    if (i % 3 == 0) cdeque_pop_front(dq);
+  }
+  int popped = (BIG + 2) / 3;
+  assert_contents(dq, popped, BIG - popped);
+  assert(cleanups == popped);
+
+  while (cdeque_count(dq) > 1) cdeque_pop_back(dq);
+  assert_contents(dq, popped, 1);
+  cdeque_clear(dq);
+  assert(cdeque_count(dq) == 0);
+  assert(cdeque_front(dq) == NULL);
+  assert(cleanups == BIG);
+  cdeque_dispose(dq);
+}
+
+static void test_bulk() {
+  CDeque *dq = cdeque_create(sizeof(int), 8, NULL);
+  bool reserved = cdeque_reserve(dq, 100);
+  assert(reserved);
+  reserved = cdeque_reserve(dq, UINT_MAX);
+  assert(!reserved);
+
+  int arr[BIG];
+  FOR(BIG) arr[i] = i;
+  cdeque_push_back_many(dq, arr + 50, 50);
+  cdeque_push_front_many(dq, arr, 50);
+  assert_contents(dq, 0, 100);
+
+  int out[BIG];
+  assert(cdeque_pop_front_many(dq, out, 30) == 30);
+  FOR(30) assert(out[i] == i);
+  assert(cdeque_pop_back_many(dq, out, 30) == 30);
+  FOR(30) assert(out[i] == 70 + i);
+  assert_contents(dq, 30, 40);
+
+  // Sliding window that keeps wrapping around
+  FOR(BIG / 10) {
+    cdeque_push_back_many(dq, arr + 70 + 10 * i, 10);
+    assert(cdeque_pop_front_many(dq, out, 10) == 10);
+    assert(out[0] == 30 + 10 * i);
+    if (70 + 10 * (i + 2) > BIG) break;
+  }
+
+  assert(cdeque_pop_front_many(dq, out, BIG) == 40);
+  assert(cdeque_count(dq) == 0);
+  cdeque_dispose(dq);
+}
+
+int main() {
+  test_wrapping_growth();
+  test_queue_and_stack();
+  test_bulk();
+  printf("cdeque tests: success\n");
+  return 0;
+}
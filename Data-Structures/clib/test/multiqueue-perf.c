@@ -0,0 +1,109 @@
+/**
+ * @file multiqueue-perf.c
+ * @brief Scalability of MultiQueue against a single PriorityQueue behind a mutex
+ * @details Each thread repeatedly pushes a random key and pops an element, as a
+ * scheduler would, starting from a prefilled queue.
+ * usage: perf-multiqueue [max threads] [operations per thread]
+ */
+
+#include "multiqueue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+#define PREFILL (1 << 16)
+
+struct locked_pqueue {
+  PriorityQueue *pq;
+  pthread_mutex_t lock;
+};
+
+struct bench {
+  void *queue;
+  long ops;
+};
+
+static bool cmp_ulong(const void *a, const void *b) {
+  return *(unsigned long*)a < *(unsigned long*)b;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline unsigned long next_key(unsigned long *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static void *locked_worker(void *arg) {
+  struct bench *b = arg;
+  struct locked_pqueue *lq = b->queue;
+  unsigned long state = (unsigned long) (uintptr_t) &state | 1, key;
+  for (long i = 0; i < b->ops; ++i) {
+    key = next_key(&state);
+    pthread_mutex_lock(&lq->lock);
+    pqueue_push(lq->pq, &key);
+    pthread_mutex_unlock(&lq->lock);
+
+    pthread_mutex_lock(&lq->lock);
+    pqueue_pop_into(lq->pq, &key);
+    pthread_mutex_unlock(&lq->lock);
+  }
+  return NULL;
+}
+
+static void *multiqueue_worker(void *arg) {
+  struct bench *b = arg;
+  unsigned long state = (unsigned long) (uintptr_t) &state | 1, key;
+  for (long i = 0; i < b->ops; ++i) {
+    key = next_key(&state);
+    multiqueue_push(b->queue, &key);
+    multiqueue_try_pop(b->queue, &key);
+  }
+  return NULL;
+}
+
+static double run(void *queue, int nthreads, long ops, void *(*worker)(void *)) {
+  pthread_t threads[nthreads];
+  struct bench b = { queue, ops };
+  double start = now();
+  for (int i = 0; i < nthreads; ++i) pthread_create(&threads[i], NULL, worker, &b);
+  for (int i = 0; i < nthreads; ++i) pthread_join(threads[i], NULL);
+  return 2.0 * ops * nthreads / (now() - start) / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+  int max_threads = argc > 1 ? atoi(argv[1]) : 16;
+  long ops = argc > 2 ? atol(argv[2]) : 1 << 19;
+
+  printf("%-8s %18s %18s\n", "threads", "locked [Mops/s]", "multiqueue [Mops/s]");
+  for (int nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    unsigned long state = 42, key;
+
+    struct locked_pqueue lq;
+    lq.pq = pqueue_create(sizeof(key), PREFILL, 0, cmp_ulong, NULL);
+    pthread_mutex_init(&lq.lock, NULL);
+    MultiQueue *mq = multiqueue_create(sizeof(key), nthreads, 0, cmp_ulong, NULL);
+    for (int i = 0; i < PREFILL; ++i) {
+      key = next_key(&state);
+      pqueue_push(lq.pq, &key);
+      multiqueue_push(mq, &key);
+    }
+
+    double locked = run(&lq, nthreads, ops, locked_worker);
+    double relaxed = run(mq, nthreads, ops, multiqueue_worker);
+    printf("%-8d %18.2f %18.2f\n", nthreads, locked, relaxed);
+
+    pqueue_dispose(lq.pq);
+    pthread_mutex_destroy(&lq.lock);
+    multiqueue_dispose(mq);
+  }
+  return 0;
+}
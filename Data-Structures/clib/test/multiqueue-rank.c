@@ -0,0 +1,68 @@
+/**
+ * @file multiqueue-rank.c
+ * @brief Measures the rank error of MultiQueue pops
+ * @details Fills a MultiQueue configured for P threads with c heaps each with a random
+ * permutation of 0..N-1, then pops everything. The rank error of a pop is the number of
+ * elements still in the queue which are smaller than the popped one (0 for an exact queue).
+ * usage: rank-multiqueue [threads] [c] [elements]
+ */
+
+#include "multiqueue.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static bool cmp_int(const void *a, const void *b) {
+  return *(int*)a < *(int*)b;
+}
+
+// Fenwick tree over the keys counting the ones which are still in the queue
+static void fenwick_add(int *tree, int n, int i, int delta) {
+  for (++i; i <= n; i += i & -i) tree[i] += delta;
+}
+
+static int fenwick_prefix(const int *tree, int i) {
+  int sum = 0;
+  for (; i > 0; i -= i & -i) sum += tree[i];
+  return sum;
+}
+
+int main(int argc, char *argv[]) {
+  int nthreads = argc > 1 ? atoi(argv[1]) : 8;
+  int c = argc > 2 ? atoi(argv[2]) : MULTIQUEUE_DEFAULT_C;
+  int n = argc > 3 ? atoi(argv[3]) : 1 << 20;
+
+  int *keys = malloc(n * sizeof(int));
+  int *tree = calloc(n + 1, sizeof(int));
+  for (int i = 0; i < n; ++i) keys[i] = i;
+  srand(0);
+  for (int i = n - 1; i > 0; --i) {
+    int j = rand() % (i + 1);
+    int tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+
+  MultiQueue *mq = multiqueue_create(sizeof(int), nthreads, c, cmp_int, NULL);
+  for (int i = 0; i < n; ++i) {
+    multiqueue_push(mq, &keys[i]);
+    fenwick_add(tree, n, keys[i], 1);
+  }
+
+  double total = 0;
+  long max = 0;
+  int key;
+  while (multiqueue_try_pop(mq, &key)) {
+    long rank = fenwick_prefix(tree, key); // remaining keys smaller than key
+    total += rank;
+    if (rank > max) max = rank;
+    fenwick_add(tree, n, key, -1);
+  }
+
+  printf("threads: %d, c: %d, heaps: %d, elements: %d\n", nthreads, c, nthreads * c, n);
+  printf("mean rank error: %.2f, max rank error: %ld\n", total / n, max);
+
+  multiqueue_dispose(mq);
+  free(tree);
+  free(keys);
+  return 0;
+}
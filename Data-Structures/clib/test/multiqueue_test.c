@@ -0,0 +1,90 @@
+
+#include "multiqueue.h"
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define NTHREADS 4
+#define PER_THREAD 50000
+
+#define FOR(N) for (int i = 0; i < N; ++i)
+
+static bool cmp_int(const void *a, const void *b) {
+  return *(int*)a < *(int*)b;
+}
+
+struct worker {
+  MultiQueue *mq;
+  int id;
+  long sum;
+};
+
+// Pushes its share of the numbers and pops as many as it pushed
+static void *work(void *arg) {
+  struct worker *w = arg;
+  int x;
+  FOR(PER_THREAD) {
+    x = w->id * PER_THREAD + i;
+    multiqueue_push(w->mq, &x);
+    if (i % 2) {
+      while (!multiqueue_try_pop(w->mq, &x));
+      w->sum += x;
+      while (!multiqueue_try_pop(w->mq, &x));
+      w->sum += x;
+    }
+  }
+  return NULL;
+}
+
+static void test_sequential() {
+  MultiQueue *mq = multiqueue_create(sizeof(int), 1, 1, cmp_int, NULL);
+  int x;
+  bool popped = multiqueue_try_pop(mq, &x);
+  assert(!popped);
+
+  // A single heap is an exact priority queue
+  FOR(1000) {
+    x = 999 - i;
+    multiqueue_push(mq, &x);
+  }
+  assert(multiqueue_size(mq) == 1000);
+  FOR(1000) {
+    popped = multiqueue_try_pop(mq, &x);
+    assert(popped && x == i);
+  }
+  popped = multiqueue_try_pop(mq, &x);
+  assert(!popped);
+  multiqueue_dispose(mq);
+}
+
+static void test_concurrent() {
+  MultiQueue *mq = multiqueue_create(sizeof(int), NTHREADS, 0, cmp_int, NULL);
+  pthread_t threads[NTHREADS];
+  struct worker workers[NTHREADS];
+  FOR(NTHREADS) {
+    workers[i] = (struct worker) { mq, i, 0 };
+    pthread_create(&threads[i], NULL, work, &workers[i]);
+  }
+
+  long sum = 0;
+  FOR(NTHREADS) {
+    pthread_join(threads[i], NULL);
+    sum += workers[i].sum;
+  }
+
+  // Every element pushed was popped exactly once
+  long n = (long) NTHREADS * PER_THREAD;
+  assert(sum == n * (n - 1) / 2);
+  assert(multiqueue_size(mq) == 0);
+  int x;
+  bool popped = multiqueue_try_pop(mq, &x);
+  assert(!popped);
+  multiqueue_dispose(mq);
+}
+
+int main() {
+  test_sequential();
+  test_concurrent();
+  printf("multiqueue tests: success\n");
+  return 0;
+}
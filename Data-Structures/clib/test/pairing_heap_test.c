@@ -0,0 +1,144 @@
+
+#include "pairing_heap.h"
+#include <stdio.h>
+#include <assert.h>
+#include <limits.h>
+
+#define BIG 10000
+#define SHARDS 8
+
+#define FOR(N) for (int i = 0; i < N; ++i)
+
+typedef struct {
+  int priority;
+  int id;
+} Task;
+
+static bool cmp_task(const void *a, const void *b) {
+  return ((const Task*) a)->priority < ((const Task*) b)->priority;
+}
+
+static int cleanups = 0;
+static void count_cleanup(void *el) {
+  (void) el;
+  cleanups++;
+}
+
+static void assert_ordering(PairingHeap *ph, const int *priorities) {
+  int last = INT_MIN;
+  Task t;
+  while (!pheap_empty(ph)) {
+    pheap_pop_into(ph, &t);
+    assert(t.priority == priorities[t.id]);
+    assert(last <= t.priority);
+    last = t.priority;
+  }
+}
+
+static void test_push_pop() {
+  PairingHeap *ph = pheap_create(sizeof(Task), cmp_task, count_cleanup);
+  static int priorities[BIG];
+  FOR(BIG) {
+    Task t = { rand() % BIG, i };
+    priorities[i] = t.priority;
+    pheap_push(ph, &t);
+  }
+  assert(pheap_size(ph) == BIG);
+
+  // pop half (cleaning them up) and check the rest comes out in order
+  int last = -1;
+  FOR(BIG / 2) {
+    Task *t = pheap_top(ph);
+    assert(last <= t->priority);
+    last = t->priority;
+    pheap_pop(ph);
+  }
+  assert(cleanups == BIG / 2);
+  assert_ordering(ph, priorities);
+  pheap_dispose(ph);
+}
+
+static void test_decrease_key_and_remove() {
+  PairingHeap *ph = pheap_create(sizeof(Task), cmp_task, count_cleanup);
+  static PHNode *nodes[BIG];
+  static int priorities[BIG];
+  static bool removed[BIG];
+  FOR(BIG) {
+    Task t = { BIG + rand() % BIG, i };
+    priorities[i] = t.priority;
+    removed[i] = false;
+    nodes[i] = pheap_push(ph, &t);
+  }
+  // Make it a real tree before modifying it
+  Task t;
+  pheap_pop_into(ph, &t);
+  removed[t.id] = true;
+
+  cleanups = 0;
+  int nremoved = 0;
+  FOR(BIG) {
+    int id = rand() % BIG;
+    if (removed[id]) continue;
+    if (i % 4 == 0) {
+      pheap_remove(ph, nodes[id]);
+      removed[id] = true;
+      nremoved++;
+      continue;
+    }
+    Task *task = pheap_get(nodes[id]);
+    assert(task->id == id);
+    task->priority -= rand() % BIG;
+    priorities[id] = task->priority;
+    pheap_decrease_key(ph, nodes[id]);
+  }
+  assert(cleanups == nremoved);
+  assert(pheap_size(ph) == BIG - 1 - nremoved);
+  assert_ordering(ph, priorities);
+  pheap_dispose(ph);
+}
+
+static void test_meld() {
+  PairingHeap *shards[SHARDS];
+  static int priorities[BIG];
+  FOR(SHARDS) shards[i] = pheap_create(sizeof(Task), cmp_task, count_cleanup);
+  FOR(BIG) {
+    Task t = { rand() % BIG, i };
+    priorities[i] = t.priority;
+    pheap_push(shards[i % SHARDS], &t);
+    if (i % 3 == 0) pheap_pop_into(shards[i % SHARDS], &t), priorities[t.id] = -1;
+  }
+
+  PairingHeap *global = pheap_create(sizeof(Task), cmp_task, count_cleanup);
+  int total = 0;
+  FOR(SHARDS) {
+    total += pheap_size(shards[i]);
+    pheap_meld(global, shards[i]);
+    assert(pheap_empty(shards[i]));
+  }
+  assert(pheap_size(global) == total);
+
+  // The melded nodes are reused by the shards and the global heap alike
+  FOR(SHARDS) {
+    Task t = { -i - 1, 0 };
+    pheap_push(shards[i], &t);
+    pheap_dispose(shards[i]);
+  }
+
+  cleanups = 0;
+  FOR(BIG / 2) {
+    Task t;
+    pheap_pop_into(global, &t);
+    assert(t.priority == priorities[t.id]);
+    pheap_push(global, &t);
+  }
+  pheap_dispose(global);
+  assert(cleanups == total);
+}
+
+int main() {
+  test_push_pop();
+  test_decrease_key_and_remove();
+  test_meld();
+  printf("pairing heap tests: success\n");
+  return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file pq-perf.c
+ * @brief Times pushing and popping a large heap for different heap arities, and
+ * for the 4-ary queue generated by PQUEUE_DEFINE
+ * usage: perf-pq [elements]
+ */
+
+#include "priority_queue.h"
+#include "pqueue_typed.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+  unsigned long priority;
+  unsigned long payload;
+} Element;
+
+PQUEUE_DEFINE(ElementQueue, Element, a.priority < b.priority)
+
+static bool cmp_element(const void *a, const void *b) {
+  return ((const Element*) a)->priority < ((const Element*) b)->priority;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  int n = argc > 1 ? atoi(argv[1]) : 1 << 22;
+
+  Element *elements = malloc(n * sizeof(Element));
+  srand(0);
+  for (int i = 0; i < n; ++i) {
+    elements[i].priority = (unsigned long) rand() << 16 ^ (unsigned long) rand();
+    elements[i].payload = (unsigned long) i;
+  }
+
+  printf("%-6s %12s %12s %12s\n", "arity", "push [ns]", "pop [ns]", "heapify [ns]");
+  for (unsigned int arity = 2; arity <= 8; arity *= 2) {
+    PriorityQueue *pq = pqueue_create(sizeof(Element), n, arity, cmp_element, NULL);
+
+    double start = now();
+    for (int i = 0; i < n; ++i) pqueue_push(pq, &elements[i]);
+    double pushed = now();
+    while (!pqueue_empty(pq)) pqueue_pop(pq);
+    double popped = now();
+    pqueue_dispose(pq);
+
+    pq = pqueue_create_from(elements, n, sizeof(Element), arity, cmp_element, NULL);
+    double heapified = now();
+    pqueue_dispose(pq);
+
+    printf("%-6u %12.1f %12.1f %12.1f\n", arity, (pushed - start) * 1e9 / n,
+           (popped - pushed) * 1e9 / n, (heapified - popped) * 1e9 / n);
+  }
+
+  ElementQueue q;
+  ElementQueue_init(&q, n);
+  double start = now();
+  for (int i = 0; i < n; ++i) ElementQueue_push(&q, elements[i]);
+  double pushed = now();
+  unsigned long sum = 0;
+  while (!ElementQueue_empty(&q)) sum += ElementQueue_pop(&q).payload;
+  double popped = now();
+  ElementQueue_destroy(&q);
+  printf("%-6s %12.1f %12.1f %12s\n", "typed", (pushed - start) * 1e9 / n,
+         (popped - pushed) * 1e9 / n, "");
+  if (sum != (unsigned long) n * (n - 1) / 2) return 1;
+
+  free(elements);
+  return 0;
+}
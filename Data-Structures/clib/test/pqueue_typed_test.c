@@ -0,0 +1,75 @@
+#include "pqueue_typed.h"
+#include <stdint.h>
+
+#define BIG 100000
+
+#define FOR(N) for (int i = 0; i < N; ++i)
+
+typedef struct {
+  int priority;
+  int id;
+} Task;
+
+PQUEUE_DEFINE(U64Queue, uint64_t, a < b)
+PQUEUE_DEFINE(TaskQueue, Task, a.priority < b.priority || (a.priority == b.priority && a.id < b.id))
+
+static int cmp_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+static void test_sorts() {
+  static uint64_t keys[BIG];
+  U64Queue q;
+  U64Queue_init(&q, 0);
+  FOR(BIG) {
+    keys[i] = (uint64_t) rand() << 32 ^ (uint64_t) rand();
+    U64Queue_push(&q, keys[i]);
+  }
+  assert(U64Queue_size(&q) == BIG);
+
+  qsort(keys, BIG, sizeof(uint64_t), cmp_u64);
+  FOR(BIG) {
+    assert(U64Queue_top(&q) == keys[i]);
+    uint64_t popped = U64Queue_pop(&q);
+    assert(popped == keys[i]);
+  }
+  assert(U64Queue_empty(&q));
+  U64Queue_destroy(&q);
+}
+
+static void test_interleaved() {
+  // ties are broken by id, so the order of pops is fully determined
+  TaskQueue q;
+  TaskQueue_init(&q, 4);
+  static int popped[BIG];
+  int next_id = 0;
+  Task last = { -1, -1 };
+  for (int round = 0; round < 10; ++round) {
+    FOR(BIG / 10) {
+      Task t = { last.priority + rand() % 100, next_id++ };
+      TaskQueue_push(&q, t);
+    }
+
+    // pops never go backwards, since pushes are never below the last pop
+    FOR(BIG / 20) {
+      Task t = TaskQueue_pop(&q);
+      assert(!TaskQueue_less(t, last));
+      popped[t.id]++;
+      last = t;
+    }
+  }
+  while (!TaskQueue_empty(&q)) popped[TaskQueue_pop(&q).id]++;
+  FOR(BIG) assert(popped[i] == 1);
+
+  TaskQueue_clear(&q);
+  assert(TaskQueue_size(&q) == 0);
+  TaskQueue_destroy(&q);
+}
+
+int main() {
+  test_sorts();
+  test_interleaved();
+  printf("Typed priority queue tests passed\n");
+  return 0;
+}
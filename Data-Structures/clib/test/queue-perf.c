@@ -0,0 +1,194 @@
+/**
+ * @file queue-perf.c
+ * @brief Throughput of the concurrent queues against a mutex-protected CList
+ * @details For each thread count P, runs P producers and P consumers moving a fixed
+ * number of elements through one queue and reports millions of elements per second.
+ * usage: perf-queue [max threads per side] [elements]
+ */
+
+#include "clist.h"
+#include "mpmc_queue.h"
+#include "spsc_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#define CAPACITY 1024
+#define BATCH 64
+
+typedef struct {
+  long payload[2]; // 16 byte elements, like a small task descriptor
+} Element;
+
+/**
+ * @struct locked_list
+ * @brief The baseline: a CList work queue guarded by a mutex and condition variables
+ */
+struct locked_list {
+  CList *list;
+  pthread_mutex_t lock;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+};
+
+struct bench {
+  void *queue;
+  long per_thread;
+};
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void *list_producer(void *arg) {
+  struct bench *b = arg;
+  struct locked_list *ll = b->queue;
+  Element e = { { 0, 0 } };
+  for (long i = 0; i < b->per_thread; ++i) {
+    e.payload[0] = i;
+    pthread_mutex_lock(&ll->lock);
+    while (clist_count(ll->list) >= CAPACITY) pthread_cond_wait(&ll->not_full, &ll->lock);
+    clist_push_back(ll->list, &e);
+    pthread_cond_signal(&ll->not_empty);
+    pthread_mutex_unlock(&ll->lock);
+  }
+  return NULL;
+}
+
+static void *list_consumer(void *arg) {
+  struct bench *b = arg;
+  struct locked_list *ll = b->queue;
+  Element e;
+  for (long i = 0; i < b->per_thread; ++i) {
+    pthread_mutex_lock(&ll->lock);
+    while (clist_count(ll->list) == 0) pthread_cond_wait(&ll->not_empty, &ll->lock);
+    e = *(Element *) clist_front(ll->list);
+    clist_pop_front(ll->list);
+    pthread_cond_signal(&ll->not_full);
+    pthread_mutex_unlock(&ll->lock);
+  }
+  (void) e;
+  return NULL;
+}
+
+static void *mpmc_producer(void *arg) {
+  struct bench *b = arg;
+  Element e = { { 0, 0 } };
+  for (long i = 0; i < b->per_thread; ++i) {
+    e.payload[0] = i;
+    mpmcq_push(b->queue, &e);
+  }
+  return NULL;
+}
+
+static void *mpmc_consumer(void *arg) {
+  struct bench *b = arg;
+  Element e;
+  for (long i = 0; i < b->per_thread; ++i) mpmcq_pop(b->queue, &e);
+  return NULL;
+}
+
+static void *spsc_producer(void *arg) {
+  struct bench *b = arg;
+  Element e = { { 0, 0 } };
+  for (long i = 0; i < b->per_thread; ++i) {
+    e.payload[0] = i;
+    spsc_push(b->queue, &e);
+  }
+  return NULL;
+}
+
+static void *spsc_consumer(void *arg) {
+  struct bench *b = arg;
+  Element e;
+  for (long i = 0; i < b->per_thread; ++i) spsc_pop(b->queue, &e);
+  return NULL;
+}
+
+static void *spsc_batch_producer(void *arg) {
+  struct bench *b = arg;
+  Element batch[BATCH] = { { { 0, 0 } } };
+  for (long i = 0; i < b->per_thread;) {
+    long n = b->per_thread - i < BATCH ? b->per_thread - i : BATCH;
+    unsigned int pushed = spsc_try_push_many(b->queue, batch, (unsigned int) n);
+    if (pushed == 0) sched_yield();
+    i += pushed;
+  }
+  return NULL;
+}
+
+static void *spsc_batch_consumer(void *arg) {
+  struct bench *b = arg;
+  Element batch[BATCH];
+  for (long i = 0; i < b->per_thread;) {
+    unsigned int popped = spsc_try_pop_many(b->queue, batch, BATCH);
+    if (popped == 0) sched_yield();
+    i += popped;
+  }
+  return NULL;
+}
+
+static void run(const char *name, void *queue, int nthreads, long elements,
+                void *(*producer)(void *), void *(*consumer)(void *)) {
+  pthread_t producers[nthreads], consumers[nthreads];
+  struct bench b = { queue, elements / nthreads };
+
+  double start = now();
+  for (int i = 0; i < nthreads; ++i) {
+    pthread_create(&producers[i], NULL, producer, &b);
+    pthread_create(&consumers[i], NULL, consumer, &b);
+  }
+  for (int i = 0; i < nthreads; ++i) {
+    pthread_join(producers[i], NULL);
+    pthread_join(consumers[i], NULL);
+  }
+  double elapsed = now() - start;
+
+  printf("%-14s %3d x %-3d %8.2f M elem/s\n", name, nthreads, nthreads,
+         b.per_thread * nthreads / elapsed / 1e6);
+}
+
+int main(int argc, char *argv[]) {
+  int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+  long elements = argc > 2 ? atol(argv[2]) : 1 << 21;
+
+  printf("%-14s %9s %17s\n", "queue", "threads", "throughput");
+  for (int nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    struct locked_list ll;
+    ll.list = clist_create(sizeof(Element), NULL);
+    pthread_mutex_init(&ll.lock, NULL);
+    pthread_cond_init(&ll.not_empty, NULL);
+    pthread_cond_init(&ll.not_full, NULL);
+    run("clist+mutex", &ll, nthreads, elements, list_producer, list_consumer);
+    clist_dispose(ll.list);
+    pthread_mutex_destroy(&ll.lock);
+    pthread_cond_destroy(&ll.not_empty);
+    pthread_cond_destroy(&ll.not_full);
+
+    MPMCQueue *q = mpmcq_create(sizeof(Element), CAPACITY, WAIT_SPIN, NULL);
+    run("mpmc spin", q, nthreads, elements, mpmc_producer, mpmc_consumer);
+    mpmcq_dispose(q);
+
+    q = mpmcq_create(sizeof(Element), CAPACITY, WAIT_BLOCK, NULL);
+    run("mpmc block", q, nthreads, elements, mpmc_producer, mpmc_consumer);
+    mpmcq_dispose(q);
+  }
+
+  SPSCRing *r = spsc_create(sizeof(Element), CAPACITY, WAIT_SPIN, NULL);
+  run("spsc spin", r, 1, elements, spsc_producer, spsc_consumer);
+  spsc_dispose(r);
+
+  r = spsc_create(sizeof(Element), CAPACITY, WAIT_BLOCK, NULL);
+  run("spsc block", r, 1, elements, spsc_producer, spsc_consumer);
+  spsc_dispose(r);
+
+  r = spsc_create(sizeof(Element), CAPACITY, WAIT_SPIN, NULL);
+  run("spsc batched", r, 1, elements, spsc_batch_producer, spsc_batch_consumer);
+  spsc_dispose(r);
+
+  return 0;
+}
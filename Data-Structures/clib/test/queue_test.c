@@ -0,0 +1,151 @@
+
+#include "mpmc_queue.h"
+#include "spsc_ring.h"
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+
+#define CAPACITY 64
+#define PER_THREAD 100000
+#define NTHREADS 4
+
+#define FOR(N) for (int i = 0; i < N; ++i)
+
+static void test_mpmc_fifo(void) {
+  MPMCQueue *q = mpmcq_create(sizeof(int), CAPACITY - 3, WAIT_SPIN, NULL);
+  assert(mpmcq_capacity(q) == CAPACITY);
+
+  int x;
+  bool ok = mpmcq_try_pop(q, &x);
+  assert(!ok);
+  FOR(CAPACITY) {
+    ok = mpmcq_try_push(q, &i);
+    assert(ok);
+  }
+  ok = mpmcq_try_push(q, &x);
+  assert(!ok);
+  assert(mpmcq_size(q) == CAPACITY);
+
+  FOR(CAPACITY) {
+    ok = mpmcq_try_pop(q, &x);
+    assert(ok && x == i);
+  }
+  ok = mpmcq_try_pop(q, &x);
+  assert(!ok);
+  mpmcq_dispose(q);
+}
+
+static void test_spsc_fifo(void) {
+  SPSCRing *r = spsc_create(sizeof(int), CAPACITY, WAIT_SPIN, NULL);
+  int x;
+  bool ok = spsc_try_pop(r, &x);
+  assert(!ok);
+
+  // staged elements are invisible until published
+  FOR(10) {
+    ok = spsc_stage(r, &i);
+    assert(ok);
+  }
+  ok = spsc_try_pop(r, &x);
+  assert(!ok);
+  spsc_publish(r);
+
+  int batch[CAPACITY];
+  FOR(CAPACITY) batch[i] = 10 + i;
+  unsigned int n = spsc_try_push_many(r, batch, CAPACITY);
+  assert(n == CAPACITY - 10);
+  ok = spsc_try_push(r, &x);
+  assert(!ok);
+
+  // pop across the wrap-around point
+  n = spsc_try_pop_many(r, batch, 20);
+  assert(n == 20);
+  FOR(20) assert(batch[i] == i);
+  FOR(20) batch[i] = CAPACITY + i;
+  n = spsc_try_push_many(r, batch, 20);
+  assert(n == 20);
+  n = spsc_try_pop_many(r, batch, CAPACITY);
+  assert(n == CAPACITY);
+  FOR(CAPACITY) assert(batch[i] == 20 + i);
+  spsc_dispose(r);
+}
+
+struct worker {
+  MPMCQueue *q;
+  SPSCRing *r;
+  long sum;
+};
+
+static void *mpmc_producer(void *arg) {
+  struct worker *w = arg;
+  FOR(PER_THREAD) mpmcq_push(w->q, &i);
+  return NULL;
+}
+
+static void *mpmc_consumer(void *arg) {
+  struct worker *w = arg;
+  int x;
+  FOR(PER_THREAD) {
+    mpmcq_pop(w->q, &x);
+    w->sum += x;
+  }
+  return NULL;
+}
+
+static void test_mpmc_threads(WaitStrategy wait) {
+  MPMCQueue *q = mpmcq_create(sizeof(int), CAPACITY, wait, NULL);
+  pthread_t producers[NTHREADS], consumers[NTHREADS];
+  struct worker workers[NTHREADS];
+
+  FOR(NTHREADS) {
+    workers[i] = (struct worker) { q, NULL, 0 };
+    pthread_create(&producers[i], NULL, mpmc_producer, &workers[i]);
+    pthread_create(&consumers[i], NULL, mpmc_consumer, &workers[i]);
+  }
+
+  long sum = 0;
+  FOR(NTHREADS) {
+    pthread_join(producers[i], NULL);
+    pthread_join(consumers[i], NULL);
+    sum += workers[i].sum;
+  }
+
+  assert(sum == (long) NTHREADS * PER_THREAD * (PER_THREAD - 1) / 2);
+  assert(mpmcq_size(q) == 0);
+  mpmcq_dispose(q);
+}
+
+static void *spsc_producer(void *arg) {
+  struct worker *w = arg;
+  FOR(PER_THREAD) spsc_push(w->r, &i);
+  return NULL;
+}
+
+static void test_spsc_threads(WaitStrategy wait) {
+  SPSCRing *r = spsc_create(sizeof(int), CAPACITY, wait, NULL);
+  struct worker w = { NULL, r, 0 };
+  pthread_t producer;
+  pthread_create(&producer, NULL, spsc_producer, &w);
+
+  int x;
+  FOR(PER_THREAD) {
+    spsc_pop(r, &x);
+    assert(x == i); // single producer, so order must be preserved exactly
+  }
+
+  pthread_join(producer, NULL);
+  spsc_dispose(r);
+}
+
+int main() {
+  test_mpmc_fifo();
+  test_spsc_fifo();
+
+  test_mpmc_threads(WAIT_SPIN);
+  test_mpmc_threads(WAIT_BLOCK);
+  test_spsc_threads(WAIT_SPIN);
+  test_spsc_threads(WAIT_BLOCK);
+
+  printf("queue tests: success\n");
+  return 0;
+}
@@ -39,8 +39,8 @@ static void print_heap(PriorityQueue* pq) {
   printf("\n");
 }
 
-int main() {
-  PriorityQueue* pq = pqueue_create(sizeof(int), 0, cmp_int, NULL);
+static void test_arity(unsigned int arity) {
+  PriorityQueue* pq = pqueue_create(sizeof(int), 0, arity, cmp_int, NULL);
 
   FOR(SMALL) pqueue_push(pq, &i);
 
@@ -68,5 +68,132 @@ int main() {
   assert_ordering(pq);
 
   pqueue_dispose(pq);
+}
+
+static void test_bulk(unsigned int arity) {
+  static int arr[BIG];
+  FOR(BIG) arr[i] = rand();
+
+  PriorityQueue* pq = pqueue_create_from(arr, BIG, sizeof(int), arity, cmp_int, NULL);
+  assert_size(pq, BIG);
+  assert_ordering(pq);
+
+  // a big batch into an empty queue is heapified, small batches are sifted
+  pqueue_push_many(pq, arr, BIG, NULL);
+  assert_size(pq, BIG);
+  FOR(BIG / 10) pqueue_push_many(pq, arr + 10 * i, 3, NULL);
+  assert_size(pq, BIG + 3 * (BIG / 10));
+
+  int last, x;
+  pqueue_pop_into(pq, &last);
+  while (!pqueue_empty(pq)) {
+    pqueue_pop_into(pq, &x);
+    assert(last <= x);
+    last = x;
+  }
+  pqueue_dispose(pq);
+}
+
+typedef struct {
+  int priority;
+  int id;
+} Task;
+
+static bool cmp_task(const void *a, const void *b) {
+  return ((const Task*) a)->priority < ((const Task*) b)->priority;
+}
+
+// Decrease/increase keys and remove elements through their handles, checking
+// against a plain array of the priorities each id should have
+static void test_addressable(unsigned int arity) {
+  PriorityQueue* pq = pqueue_create_addressable(sizeof(Task), 0, arity, cmp_task, NULL);
+
+  static PQHandle handles[BIG];
+  static int priorities[BIG];
+  static bool removed[BIG];
+  static Task tasks[BIG / 2];
+  FOR(BIG) {
+    Task t = { rand() % BIG, i };
+    priorities[i] = t.priority;
+    removed[i] = false;
+    if (i < BIG / 2) {
+      tasks[i] = t;
+      continue;
+    }
+    handles[i] = pqueue_push(pq, &t);
+    assert(pqueue_contains(pq, handles[i]));
+  }
+  pqueue_push_many(pq, tasks, BIG / 2, handles);
+
+  FOR(BIG) {
+    int id = rand() % BIG;
+    if (removed[id]) continue;
+    Task* t = pqueue_get(pq, handles[id]);
+    assert(t->id == id);
+    if (i % 5 == 0) {
+      pqueue_remove(pq, handles[id]);
+      removed[id] = true;
+      continue;
+    }
+    t->priority = rand() % BIG;
+    priorities[id] = t->priority;
+    pqueue_update(pq, handles[id]);
+  }
+
+  int count = 0;
+  FOR(BIG) if (!removed[i]) count++;
+  assert_size(pq, count);
+
+  int last = -1;
+  while (!pqueue_empty(pq)) {
+    Task t = *(Task*) pqueue_top(pq);
+    assert(!removed[t.id]);
+    assert(t.priority == priorities[t.id]);
+    assert(last <= t.priority);
+    last = t.priority;
+    pqueue_pop(pq);
+    assert(!pqueue_contains(pq, handles[t.id]));
+  }
+
+  pqueue_dispose(pq);
+}
+
+// Handles of elements which left the queue stay out of it when their slots are reused
+static void test_stale_handles(void) {
+  PriorityQueue* pq = pqueue_create_addressable(sizeof(Task), 0, 0, cmp_task, NULL);
+
+  Task a = { 1, 0 }, b = { 2, 1 };
+  PQHandle popped = pqueue_push(pq, &a);
+  pqueue_pop(pq);
+  PQHandle reused = pqueue_push(pq, &b);
+  assert(reused != popped);
+  assert(!pqueue_contains(pq, popped));
+  assert(pqueue_contains(pq, reused));
+
+  pqueue_remove(pq, reused);
+  PQHandle after_remove = pqueue_push(pq, &a);
+  assert(!pqueue_contains(pq, reused));
+  assert(!pqueue_contains(pq, popped));
+
+  pqueue_clear(pq);
+  PQHandle after_clear = pqueue_push(pq, &b);
+  assert(!pqueue_contains(pq, after_remove));
+  assert(pqueue_contains(pq, after_clear));
+  assert(((Task*) pqueue_get(pq, after_clear))->id == 1);
+
+  pqueue_dispose(pq);
+}
+
+int main() {
+  test_addressable(2);
+  test_addressable(4);
+  test_stale_handles();
+  test_bulk(2);
+  test_bulk(4);
+
+  test_arity(2);
+  test_arity(4);
+  test_arity(8);
+  test_arity(0);
   return 0;
 }
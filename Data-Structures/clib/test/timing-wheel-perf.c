@@ -0,0 +1,115 @@
+/**
+ * @file timing-wheel-perf.c
+ * @brief Compares the timing wheel with a timer queue built on the addressable
+ * PriorityQueue alone, for lots of outstanding timers which mostly get cancelled
+ * (like timeouts on requests which complete in time)
+ * usage: perf-twheel [timers] [ticks]
+ */
+
+#include "timing_wheel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+  uint64_t expires;
+  int id;
+} Event;
+
+static bool cmp_event(const void *a, const void *b) {
+  return ((const Event*) a)->expires < ((const Event*) b)->expires;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static long expired = 0;
+static void count_expired(void *elems, int n, void *arg) {
+  (void) elems;
+  (void) arg;
+  expired += n;
+}
+
+static void report(const char *name, int n, double start, double inserted, double cancelled,
+                   double done) {
+  printf("%-8s %12.1f %12.1f %12.1f %12.3f\n", name, (inserted - start) * 1e9 / n,
+         (cancelled - inserted) * 1e9 / (n - n / 10), (done - cancelled) * 1e9 / (n / 10),
+         done - start);
+}
+
+int main(int argc, char *argv[]) {
+  int n = argc > 1 ? atoi(argv[1]) : 1 << 21;
+  uint64_t ticks = argc > 2 ? strtoull(argv[2], NULL, 10) : 1 << 20;
+
+  uint64_t *expiries = malloc(n * sizeof(uint64_t));
+  int *order = malloc(n * sizeof(int));
+  srand(0);
+  for (int i = 0; i < n; ++i) {
+    expiries[i] = 1 + ((uint64_t) rand() << 16 ^ (uint64_t) rand()) % ticks;
+    order[i] = i;
+  }
+  for (int i = n - 1; i > 0; --i) { // cancel in random order
+    int j = rand() % (i + 1);
+    int tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+  int ncancel = n - n / 10;
+
+  printf("%d timers over %lu ticks, %d cancelled\n", n, (unsigned long) ticks, ncancel);
+  printf("%-8s %12s %12s %12s %12s\n", "", "insert [ns]", "cancel [ns]", "expire [ns]", "total [s]");
+
+  // Timing wheel
+  Timer **timers = malloc(n * sizeof(Timer *));
+  TimingWheel *tw = twheel_create(sizeof(Event), 0, count_expired, NULL, NULL);
+  double start = now();
+  for (int i = 0; i < n; ++i) {
+    Event e = { expiries[i], i };
+    timers[i] = twheel_insert(tw, e.expires, &e);
+  }
+  double inserted = now();
+  for (int i = 0; i < ncancel; ++i) twheel_cancel(tw, timers[order[i]]);
+  double cancelled = now();
+  for (uint64_t t = 1; t <= ticks; ++t) twheel_advance(tw, t);
+  double done = now();
+  report("wheel", n, start, inserted, cancelled, done);
+  twheel_dispose(tw);
+  free(timers);
+  long wheel_expired = expired;
+
+  // Heap only
+  PQHandle *handles = malloc(n * sizeof(PQHandle));
+  PriorityQueue *pq = pqueue_create_addressable(sizeof(Event), n, 0, cmp_event, NULL);
+  expired = 0;
+  start = now();
+  for (int i = 0; i < n; ++i) {
+    Event e = { expiries[i], i };
+    handles[i] = pqueue_push(pq, &e);
+  }
+  inserted = now();
+  for (int i = 0; i < ncancel; ++i) pqueue_remove(pq, handles[order[i]]);
+  cancelled = now();
+  Event e;
+  for (uint64_t t = 1; t <= ticks; ++t) {
+    while (!pqueue_empty(pq) && ((const Event *) pqueue_top(pq))->expires <= t) {
+      pqueue_pop_into(pq, &e);
+      count_expired(&e, 1, NULL);
+    }
+  }
+  done = now();
+  report("heap", n, start, inserted, cancelled, done);
+  pqueue_dispose(pq);
+  free(handles);
+
+  if (expired != wheel_expired || expired != n - ncancel) {
+    fprintf(stderr, "expired %ld (wheel) and %ld (heap) timers, expected %d\n",
+            wheel_expired, expired, n - ncancel);
+    return 1;
+  }
+  free(expiries);
+  free(order);
+  return 0;
+}
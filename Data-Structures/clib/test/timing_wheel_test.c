@@ -0,0 +1,144 @@
+#include "timing_wheel.h"
+#include <stdio.h>
+#include <assert.h>
+
+#define BIG 100000
+
+#define FOR(N) for (int i = 0; i < N; ++i)
+
+typedef struct {
+  uint64_t expires;
+  int id;
+} Event;
+
+enum { PENDING, FIRED, CANCELLED };
+
+static TimingWheel *wheel;
+static int state[BIG];
+static int fired = 0;
+static int cleanups = 0;
+
+static void check_expired(void *elems, int n, void *arg) {
+  (void) arg;
+  assert(n > 0 && n <= 256);
+  Event *events = elems;
+  FOR(n) {
+    assert(events[i].expires == twheel_now(wheel));
+    assert(state[events[i].id] == PENDING);
+    state[events[i].id] = FIRED;
+    fired++;
+  }
+}
+
+static void count_cleanup(void *el) {
+  state[((Event *) el)->id] = CANCELLED;
+  cleanups++;
+}
+
+static uint64_t random_delay(void) {
+  switch (rand() % 4) {
+    case 0: return (uint64_t) rand() % 300;                 // finest wheel
+    case 1: return (uint64_t) rand() % 100000;              // cascades
+    case 2: return (uint64_t) rand() << 1 ^ rand();         // upper wheels
+    default: return ((uint64_t) 1 << 32) + ((uint64_t) rand() << 8); // overflow queue
+  }
+}
+
+static void test_expiry() {
+  uint64_t start = ((uint64_t) 1 << 32) - 1000; // make the wheels wrap around early on
+  wheel = twheel_create(sizeof(Event), start, check_expired, NULL, count_cleanup);
+  static Timer *timers[BIG];
+
+  FOR(BIG) {
+    state[i] = PENDING;
+    Event e = { start + 1 + random_delay(), i };
+    timers[i] = twheel_insert(wheel, e.expires, &e);
+  }
+  assert(twheel_count(wheel) == BIG);
+
+  // cancel a third of them, wherever they ended up
+  int cancelled = 0;
+  for (int i = 0; i < BIG; i += 3) {
+    twheel_cancel(wheel, timers[i]);
+    assert(state[i] == CANCELLED);
+    cancelled++;
+  }
+  assert(cleanups == cancelled);
+  assert(twheel_count(wheel) == BIG - cancelled);
+
+  // advance by random steps, checking nothing is left behind
+  uint64_t now = start;
+  uint64_t end = start + ((uint64_t) 1 << 32) + ((uint64_t) RAND_MAX << 8) + 1;
+  while (now < end) {
+    now += rand() % 4 == 0 ? (uint64_t) rand() << 8 : (uint64_t) rand() % 1000;
+    twheel_advance(wheel, now);
+    assert(twheel_now(wheel) == now);
+  }
+
+  assert(fired + cancelled == BIG);
+  assert(twheel_count(wheel) == 0);
+  FOR(BIG) assert(state[i] != PENDING);
+  twheel_dispose(wheel);
+  assert(cleanups == cancelled);
+}
+
+static void reschedule(void *elems, int n, void *arg) {
+  int *remaining = arg;
+  Event *events = elems;
+  FOR(n) {
+    assert(events[i].expires == twheel_now(wheel));
+    if (--remaining[events[i].id] > 0) {
+      events[i].expires = twheel_now(wheel) + 1 + events[i].id;
+      twheel_insert(wheel, events[i].expires, &events[i]);
+    }
+  }
+}
+
+static void test_reschedule() {
+  // timers that re-arm themselves from the callback, like periodic timers
+  static int remaining[100];
+  wheel = twheel_create(sizeof(Event), 0, reschedule, remaining, NULL);
+  FOR(100) {
+    remaining[i] = 50;
+    Event e = { 1 + i, i };
+    twheel_insert(wheel, e.expires, &e);
+  }
+
+  twheel_advance(wheel, 100000);
+  FOR(100) assert(remaining[i] == 0);
+  assert(twheel_count(wheel) == 0);
+  twheel_dispose(wheel);
+}
+
+static void test_past_and_dispose() {
+  cleanups = 0;
+  fired = 0;
+  wheel = twheel_create(sizeof(Event), 500, check_expired, NULL, count_cleanup);
+
+  // already expired timers fire on the next tick
+  state[0] = PENDING;
+  Event e = { 501, 0 };
+  twheel_insert(wheel, 3, &e);
+  twheel_advance(wheel, 500);
+  assert(fired == 0);
+  twheel_advance(wheel, 501);
+  assert(fired == 1);
+
+  // pending timers are cleaned up on dispose
+  FOR(10) {
+    e.id = i;
+    state[i] = PENDING;
+    e.expires = 1000 + ((uint64_t) i << 30);
+    twheel_insert(wheel, e.expires, &e);
+  }
+  twheel_dispose(wheel);
+  assert(cleanups == 10);
+}
+
+int main() {
+  test_expiry();
+  test_reschedule();
+  test_past_and_dispose();
+  printf("Timing wheel tests passed\n");
+  return 0;
+}
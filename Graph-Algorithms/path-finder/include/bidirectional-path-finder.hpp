@@ -0,0 +1,239 @@
+/**
+ * @file bidirectional-path-finder.hpp
+ * @brief Presents the interface of a path finder which searches from both ends at once
+ *
+ * @details A forward search from the source and a backward search (over the reversed graph) from the sink
+ * take turns settling whichever of their next nodes is closer, and keep track of the shortest path through
+ * a node reached by both. Once the priorities at the top of the two queues add up to at least the length of
+ * that path, no shorter one can exist and the search stops. Each search only has to get about half way, so
+ * far fewer nodes are settled than by a search from the source alone.
+ *
+ * Bidirectional A* uses the average potential p(v) = (h(v, sink) - h(source, v)) / 2 in the forward search
+ * and -p(v) in the backward one. Both then see the same non-negative reduced edge weights (as long as h is
+ * consistent), so the stopping criterion of the plain bidirectional search still holds.
+ *
+ * The backward search needs the reversed graph. Building it takes as long as a search over the whole graph, so
+ * callers running many queries build it once with reverse_graph_type::reverse_of and pass it to each query; it is
+ * theirs to rebuild whenever the graph changes.
+ */
+
+#ifndef _BIDIRECTIONAL_PATH_FINDER_HPP_INCLUDED
+#define _BIDIRECTIONAL_PATH_FINDER_HPP_INCLUDED
+
+#include "path-finder.hpp"
+#include "csr-graph.hpp"
+#include "path.hpp"
+#include "type-traits.hpp"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @class  BidirectionalPathFinder
+ * @brief  Finds shortest paths in directed, weighted graphs by searching from both ends
+ * @tparam Graph Graph or CsrGraph
+ * @tparam Heuristic void for bidirectional Dijkstra, or a function object for bidirectional A*:
+ * heuristic(from, to) must give a consistent lower bound on the distance from node "from" to node "to"
+ */
+template <class Graph, class Heuristic=void>
+class BidirectionalPathFinder {
+public:
+  static constexpr bool use_Astar = !std::is_void<Heuristic>::value;
+
+  typedef typename Graph::data_type value_type;
+  typedef typename Graph::weight_type weight_type;
+  typedef typename if_<use_Astar, double, weight_type>::value priority_type;
+  typedef typename DefaultQueue<Graph, Heuristic>::type queue_type;
+  typedef CsrGraph<value_type, weight_type> reverse_graph_type;
+
+  BidirectionalPathFinder() = default;
+
+  template <bool enable=use_Astar>
+  explicit BidirectionalPathFinder(const typename std::enable_if<enable, Heuristic>::type& heuristic)
+    : heuristic(heuristic) {}
+
+  BidirectionalPathFinder(const BidirectionalPathFinder&) = delete;
+  BidirectionalPathFinder& operator=(const BidirectionalPathFinder&) = delete;
+
+  /**
+   * @fn BidirectionalPathFinder::find_path
+   * @brief Finds a shortest path, building the reverse of graph first. For more than one query on the same graph,
+   * pass the reverse graph instead.
+   */
+  Path<size_t> find_path(const Graph& graph, size_t source, size_t sink) {
+    return find_path(graph, reverse_graph_type::reverse_of(graph), source, sink);
+  }
+
+  /**
+   * @fn BidirectionalPathFinder::find_path
+   * @param reverse The reverse of graph as it is now, as built by reverse_graph_type::reverse_of
+   */
+  Path<size_t> find_path(const Graph& graph, const reverse_graph_type& reverse, size_t source, size_t sink) {
+    forward.start(graph.size());
+    backward.start(graph.size());
+    this->source = source;
+    this->sink = sink;
+    if constexpr (use_Astar) start_potentials(graph.size());
+
+    Path<size_t> path;
+    if (source == sink) {
+      path.nodes.push_back(source);
+      return path;
+    }
+
+    forward.reach(source, 0, source, potential(source));
+    backward.reach(sink, 0, sink, -potential(sink));
+    forward.queue.push(source);
+    backward.queue.push(sink);
+
+    found = false;
+    best = std::numeric_limits<weight_type>::max();
+    while (!forward.queue.empty() && !backward.queue.empty()) {
+      priority_type top_forward = forward.top_priority();
+      priority_type top_backward = backward.top_priority();
+      if (found && top_forward + top_backward >= (priority_type) best) break; // nothing shorter is left
+
+      if (top_forward <= top_backward) step(graph, forward, backward, 1);
+      else step(reverse, backward, forward, -1);
+    }
+
+    if (!found) return path; // return empty path - no path found
+    for (size_t v = meeting; v != source; v = forward.prevs[v]) path.nodes.push_back(v);
+    path.nodes.push_back(source);
+    std::reverse(path.nodes.begin(), path.nodes.end());
+    for (size_t v = meeting; v != sink; ) {
+      v = backward.prevs[v];
+      path.nodes.push_back(v);
+    }
+    return path;
+  }
+
+private:
+  /**
+   * @struct Search
+   * @brief The state of the search in one direction, reset lazily with epoch stamps like PathFinder
+   */
+  struct Search {
+    std::vector<weight_type> distances;
+    std::vector<size_t> prevs;          // towards the source for the forward search, the sink for the backward one
+    std::vector<priority_type> priorities;  // only for A*, otherwise the distances are the priorities
+    std::vector<uint32_t> stamps;
+    uint32_t epoch = 0;
+    queue_type queue = make_queue<queue_type, priority_type>(nullptr);
+
+    void start(size_t size) {
+      if (size > stamps.size()) {
+        distances.resize(size);
+        prevs.resize(size);
+        stamps.assign(size, 0);
+        epoch = 0;
+        if constexpr (use_Astar) {
+          priorities.resize(size);
+          queue = make_queue<queue_type>(priorities.data());
+        } else queue = make_queue<queue_type>(distances.data());
+        queue.reserve_positions(size);
+      }
+      queue.clear();
+      if (++epoch == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+      }
+    }
+
+    inline bool reached(size_t v) const { return stamps[v] == epoch; }
+
+    inline weight_type distance(size_t v) const {
+      return reached(v) ? distances[v] : std::numeric_limits<weight_type>::max();
+    }
+
+    inline void reach(size_t v, weight_type distance, size_t prev, double potential) {
+      distances[v] = distance;
+      prevs[v] = prev;
+      stamps[v] = epoch;
+      if constexpr (use_Astar) priorities[v] = distance + potential;
+      else (void) potential;
+    }
+
+    inline priority_type top_priority() {
+      size_t v = queue.top();
+      if constexpr (use_Astar) return priorities[v];
+      else return distances[v];
+    }
+  };
+
+  typename if_<use_Astar, Heuristic, Empty>::value heuristic;
+  Search forward;
+  Search backward;
+  size_t source = 0;
+  size_t sink = 0;
+
+  bool found = false;
+  weight_type best = 0;   // length of the shortest path found so far
+  size_t meeting = 0;     // node where it goes from the forward to the backward search
+
+  // The average potential of each node reached in the current query (A* only)
+  std::vector<double> potentials;
+  std::vector<uint32_t> potential_stamps;
+  uint32_t potential_epoch = 0;
+
+  /**
+   * @fn BidirectionalPathFinder::step
+   * @brief Settles the next node of one search, relaxing its edges and checking for shorter paths
+   * through nodes the other search has reached
+   * @param sign 1 for the forward search, -1 for the backward search, which uses the negated potential
+   */
+  template <class G>
+  void step(const G& g, Search& self, const Search& other, int sign) {
+    size_t v = self.queue.top();
+    self.queue.pop();
+    weight_type distance = self.distances[v];
+
+    for (Edge<weight_type> edge : g[v]) {
+      weight_type alt_distance = distance + edge.weight;
+      if (alt_distance < self.distance(edge.to)) {
+        self.reach(edge.to, alt_distance, v, sign * potential(edge.to));
+        if (self.queue.contains(edge.to)) self.queue.decrease_key(edge.to);
+        else self.queue.push(edge.to);
+      }
+
+      if (other.reached(edge.to)) {
+        weight_type through = alt_distance + other.distances[edge.to];
+        if (through < best || !found) {
+          best = through;
+          meeting = edge.to;
+          found = true;
+        }
+      }
+    }
+  }
+
+  void start_potentials(size_t size) {
+    if (size > potential_stamps.size()) {
+      potentials.resize(size);
+      potential_stamps.assign(size, 0);
+      potential_epoch = 0;
+    }
+    if (++potential_epoch == 0) {
+      std::fill(potential_stamps.begin(), potential_stamps.end(), 0);
+      potential_epoch = 1;
+    }
+  }
+
+  inline double potential(size_t v) {
+    if constexpr (use_Astar) {
+      if (potential_stamps[v] != potential_epoch) {
+        // In double even for an integer heuristic, which would lose the half and with it the consistency
+        potentials[v] = 0.5 * ((double) heuristic(v, sink) - (double) heuristic(source, v));
+        potential_stamps[v] = potential_epoch;
+      }
+      return potentials[v];
+    } else {
+      (void) v;
+      return 0;
+    }
+  }
+};
+
+#endif // _BIDIRECTIONAL_PATH_FINDER_HPP_INCLUDED
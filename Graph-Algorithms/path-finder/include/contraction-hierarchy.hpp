@@ -0,0 +1,154 @@
+/**
+ * @file contraction-hierarchy.hpp
+ * @brief Presents the interface of Contraction Hierarchies, for fast shortest path queries on road-like graphs
+ *
+ * @details Preprocessing removes ("contracts") the nodes one at a time, from least to most important. When a
+ * node v is contracted, a shortcut u -> x is added for each pair of its remaining neighbors u -> v -> x, unless
+ * a "witness" search from u finds a path to x that avoids v and is no longer. The order of the nodes is their
+ * rank, and is picked greedily by the edge difference (shortcuts added minus edges removed) plus the number of
+ * already contracted neighbors, which spreads the contraction evenly over the graph.
+ *
+ * A query runs a bidirectional Dijkstra in which both searches only follow edges (including shortcuts) to
+ * nodes of higher rank. These searches are tiny, and meet at the highest ranked node of the shortest path.
+ * The shortcuts on the path found are then unpacked recursively into the edges of the original graph.
+ *
+ * Many-to-many distance tables use buckets: an upward search from every target leaves (target, distance) in a
+ * bucket at each node it reaches, then an upward search from every source looks into the bucket of each node it
+ * reaches. Each pair meets at the highest node of its shortest path, so one search per source and per target
+ * (instead of one per pair) fills the whole table.
+ *
+ * The preprocessed hierarchy can be saved to and loaded from a binary stream.
+ */
+
+#ifndef _CONTRACTION_HIERARCHY_HPP_INCLUDED
+#define _CONTRACTION_HIERARCHY_HPP_INCLUDED
+
+#include "path.hpp"
+#include "edge.hpp"
+#include "priority-queue.hpp"
+#include "path-finder.hpp"
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+/**
+ * @class ContractionHierarchy
+ * @brief The search graph of a contraction hierarchy, with the workspace for querying it
+ * @tparam WT The type of the edge weights, which must be non-negative
+ */
+template <class WT>
+class ContractionHierarchy {
+public:
+  typedef WT weight_type;
+  typedef uint32_t node_id;
+  static constexpr node_id no_node = std::numeric_limits<node_id>::max();
+
+  /**
+   * @struct ContractionHierarchy::Options
+   * @brief Knobs of the preprocessing. Cheaper witness searches make preprocessing faster but may add
+   * unnecessary shortcuts, which makes queries slower.
+   */
+  struct Options {
+    size_t witness_settle_limit = 500;    // nodes a witness search may settle before giving up
+    int edge_difference_weight = 1;
+    int deleted_neighbors_weight = 1;
+  };
+
+  ContractionHierarchy() = default;
+
+  // The query queues point into the distance arrays, which a copy wouldn't bring along, but a move does
+  ContractionHierarchy(ContractionHierarchy&&) = default;
+  ContractionHierarchy& operator=(ContractionHierarchy&&) = default;
+  ContractionHierarchy(const ContractionHierarchy&) = delete;
+  ContractionHierarchy& operator=(const ContractionHierarchy&) = delete;
+
+  /**
+   * @fn ContractionHierarchy::build
+   * @brief Contracts every node of a graph
+   * @tparam G Graph or CsrGraph
+   */
+  template <class G>
+  static ContractionHierarchy build(const G& graph, const Options& options);
+
+  template <class G>
+  static ContractionHierarchy build(const G& graph) { return build(graph, Options()); }
+
+  /**
+   * @fn ContractionHierarchy::find_path
+   * @return The shortest path from source to sink as nodes of the original graph, or an empty path if there is none
+   */
+  Path<size_t> find_path(size_t source, size_t sink);
+
+  /**
+   * @fn ContractionHierarchy::distance
+   * @return The length of the shortest path from source to sink, or the largest WT if there is none
+   */
+  WT distance(size_t source, size_t sink);
+
+  /**
+   * @fn ContractionHierarchy::distance_matrix
+   * @brief The distances from every source to every target, by bucket-based many-to-many search
+   * @param nthreads The number of threads running the searches
+   * @return The row-major sources.size() x targets.size() matrix, with the largest WT where there is no path
+   */
+  std::vector<WT> distance_matrix(const std::vector<size_t>& sources, const std::vector<size_t>& targets,
+                                  unsigned nthreads=std::thread::hardware_concurrency()) const;
+
+  size_t size() const { return rank.size(); }
+  size_t num_shortcuts() const { return shortcuts; }
+  node_id rank_of(size_t v) const { return rank[v]; }
+
+  void save(std::ostream& os) const;
+  static ContractionHierarchy load(std::istream& is);
+
+private:
+  /**
+   * @struct UpwardGraph
+   * @brief Edges towards higher ranked nodes in compressed sparse row form. For the forward graph, node v has its
+   * out-edges v -> u, for the backward graph its in-edges u -> v (with target u). A shortcut stores the node it
+   * bypasses, and no_node for an edge of the original graph.
+   */
+  struct UpwardGraph {
+    std::vector<uint64_t> offsets;
+    std::vector<node_id> targets;
+    std::vector<WT> weights;
+    std::vector<node_id> middles;
+  };
+
+  /**
+   * @struct Search
+   * @brief The state of one direction of a query, reset lazily with epoch stamps like PathFinder
+   */
+  struct Search {
+    std::vector<WT> distances;
+    std::vector<node_id> prevs;   // the node this one was reached from, no_node for the start
+    std::vector<uint32_t> stamps;
+    uint32_t epoch = 0;
+    priority_queue<size_t, true, ComparePriorities<WT>> queue;
+
+    void start(size_t size);
+    inline bool reached(size_t v) const { return stamps[v] == epoch; }
+    inline WT distance(size_t v) const { return reached(v) ? distances[v] : std::numeric_limits<WT>::max(); }
+  };
+
+  std::vector<node_id> rank;
+  UpwardGraph forward_graph;
+  UpwardGraph backward_graph;
+  size_t shortcuts = 0;
+
+  Search forward;
+  Search backward;
+
+  bool search(size_t source, size_t sink, WT& best, node_id& meeting);
+  void settle(const UpwardGraph& graph, Search& self, const Search& other, WT& best, node_id& meeting);
+  void unpack(node_id from, node_id to, node_id middle, std::vector<size_t>& nodes) const;
+  template <class Settled>
+  void upward_search(const UpwardGraph& graph, Search& search, size_t start, Settled settled) const;
+  static size_t find_edge(const UpwardGraph& graph, node_id at, node_id other);
+};
+
+#include <contraction-hierarchy.cpp>
+#endif // _CONTRACTION_HIERARCHY_HPP_INCLUDED
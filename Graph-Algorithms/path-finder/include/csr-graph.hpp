@@ -0,0 +1,106 @@
+/**
+ * @file csr-graph.hpp
+ * @brief Presents the interface of a frozen, directed, weighted graph in compressed sparse row form
+ *
+ * @details The out-edges of all nodes are stored in two contiguous arrays (targets and weights), sorted by
+ * source node, and the edges of node v are those in [offsets[v], offsets[v + 1]). Scanning the edges of a
+ * node is a sequential read, there is no allocation per node, and an edge takes 4 + sizeof(WT) bytes instead
+ * of a padded Edge<WT>. The graph can't be modified once built, and node ids must fit in 32 bits.
+ *
+ * It provides the same interface as Graph for reading (size(), operator[] and iterating over the edges of a
+ * node as Edge<WT>s), so it can be searched by PathFinder.
+ */
+
+#ifndef _CSR_GRAPH_HPP_INCLUDED
+#define _CSR_GRAPH_HPP_INCLUDED
+
+#include <graph.hpp>
+#include <edge.hpp>
+#include <vector>
+#include <tuple>
+#include <cstdint>
+
+template <class T, class WT>
+class CsrGraph {
+public:
+  typedef T data_type;
+  typedef WT weight_type;
+  typedef uint32_t node_id;
+
+  /**
+   * @class CsrGraph::edge_iterator
+   * @brief Iterates over the edges of a node, producing an Edge<WT> from the two arrays on the fly
+   */
+  class edge_iterator {
+  public:
+    edge_iterator(const node_id* target, const WT* weight) : target(target), weight(weight) {}
+    Edge<WT> operator*() const { return Edge<WT>(*weight, *target); }
+    edge_iterator& operator++() { ++target; ++weight; return *this; }
+    bool operator!=(const edge_iterator& other) const { return target != other.target; }
+    bool operator==(const edge_iterator& other) const { return target == other.target; }
+  private:
+    const node_id* target;
+    const WT* weight;
+  };
+
+  /**
+   * @class CsrGraph::edge_range
+   * @brief The out-edges of one node, taking the place of Node for reading
+   */
+  class edge_range {
+  public:
+    edge_range(const node_id* targets, const WT* weights, size_t n) : targets(targets), weights(weights), n(n) {}
+    edge_iterator begin() const { return edge_iterator(targets, weights); }
+    edge_iterator end() const { return edge_iterator(targets + n, weights + n); }
+    size_t num_edges() const { return n; }
+    Edge<WT> operator[](size_t i) const { return Edge<WT>(weights[i], targets[i]); }
+  private:
+    const node_id* targets;
+    const WT* weights;
+    size_t n;
+  };
+
+  typedef std::tuple<size_t, size_t, WT> edge_list_entry; // from, to, weight
+
+  CsrGraph() = default;
+  explicit CsrGraph(const Graph<T, WT>& graph);
+  CsrGraph(size_t num_nodes, const std::vector<edge_list_entry>& edges);
+
+  /**
+   * @brief Takes over arrays already in CSR form, such as those of parse_edge_list
+   * @param offsets The edges of node v are [offsets[v], offsets[v + 1]), so it has an entry more than there are nodes
+   */
+  CsrGraph(std::vector<size_t>&& offsets, std::vector<node_id>&& targets, std::vector<WT>&& weights)
+    : offsets(std::move(offsets)), targets(std::move(targets)), weights(std::move(weights)),
+      node_data(this->offsets.size() - 1) {}
+
+  /**
+   * @fn CsrGraph::reverse_of
+   * @brief Builds the graph with every edge of another graph reversed, e.g. for searching backwards from a sink
+   * @tparam G Graph or CsrGraph
+   * @return A graph whose node v has an edge (weight, u) for each edge (weight, v) of node u in graph
+   */
+  template <class G>
+  static CsrGraph reverse_of(const G& graph);
+
+  size_t size() const { return offsets.size() - 1; }
+  size_t num_edges() const { return targets.size(); }
+  edge_range operator[](size_t i) const;
+
+  const T& data(size_t i) const { return node_data[i]; }
+  T& data(size_t i) { return node_data[i]; }
+
+  /** The edges of node v are [edge_begin(v), edge_begin(v + 1)) in the edge arrays */
+  size_t edge_begin(size_t i) const { return offsets[i]; }
+  node_id target(size_t e) const { return targets[e]; }
+  WT weight(size_t e) const { return weights[e]; }
+
+protected:
+  std::vector<size_t> offsets = std::vector<size_t>(1, 0);
+  std::vector<node_id> targets;
+  std::vector<WT> weights;
+  std::vector<T> node_data;
+};
+
+#include <csr-graph.cpp>
+#endif // _CSR_GRAPH_HPP_INCLUDED
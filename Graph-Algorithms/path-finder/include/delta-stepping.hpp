@@ -0,0 +1,137 @@
+/**
+ * @file delta-stepping.hpp
+ * @brief Presents the interface of parallel single source shortest paths by delta-stepping
+ *
+ * @details Delta-stepping relaxes nodes in buckets of width delta rather than one at a time: bucket i holds the
+ * nodes whose tentative distance is in [i * delta, (i + 1) * delta). All nodes of the first non-empty bucket are
+ * relaxed at once, in parallel. Edges no heavier than delta ("light" edges) can put nodes back into the same
+ * bucket, so the bucket is relaxed over light edges until it stays empty; only then are the heavy edges of all
+ * nodes it held relaxed, once, since they can only reach later buckets. A small delta does little wasted work but
+ * has many buckets to go through one after the other, a large delta the other way around (delta at least as large
+ * as every weight makes it Bellman-Ford, and a delta below every weight makes it Dijkstra with ties in parallel).
+ *
+ * Each phase runs in two steps separated by a barrier. First the threads go over the nodes of the bucket, and
+ * collect the relaxations ("requests") they make in buffers of their own. The nodes of the bucket are spread over
+ * the threads' own lists, and a thread which is done with its list takes chunks of the others'. Then every thread
+ * carries out its own requests, lowering distances with compare-and-swap, and puts the nodes it improved into
+ * buckets of its own. The distances reached are the shortest ones, whatever order the relaxations happened in, so
+ * they are the same as those of Dijkstra.
+ */
+
+#ifndef _DELTA_STEPPING_HPP_INCLUDED
+#define _DELTA_STEPPING_HPP_INCLUDED
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <limits>
+#include <cstdint>
+
+/**
+ * @class  DeltaStepping
+ * @brief  One-to-all shortest paths on several threads
+ * @tparam Graph Graph or CsrGraph. The edges are copied, split into light and heavy ones, when it is constructed.
+ */
+template <class Graph>
+class DeltaStepping {
+public:
+  typedef typename Graph::weight_type weight_type;
+  typedef uint32_t node_id;
+  static constexpr weight_type unreachable = std::numeric_limits<weight_type>::max();
+
+  /**
+   * @param delta The width of the buckets, which must be positive
+   * @param nthreads The number of threads each search runs on, including the one calling run
+   */
+  DeltaStepping(const Graph& graph, weight_type delta, unsigned nthreads=std::thread::hardware_concurrency());
+
+  DeltaStepping(const DeltaStepping&) = delete;
+  DeltaStepping& operator=(const DeltaStepping&) = delete;
+
+  /**
+   * @fn DeltaStepping::run
+   * @return The distance from source to every node, or unreachable. Valid until the next run.
+   */
+  const std::vector<weight_type>& run(size_t source);
+
+  size_t size() const { return offsets.size() - 1; }
+  weight_type delta() const { return bucket_width; }
+  unsigned num_threads() const { return nthreads; }
+
+private:
+  struct Request {
+    node_id node;
+    weight_type distance;
+  };
+
+  /**
+   * @struct Worker
+   * @brief What belongs to one thread: its share of the current bucket, its requests, and its own buckets
+   */
+  struct alignas(64) Worker {
+    std::vector<node_id> frontier;      // the nodes of the phase this thread starts with
+    std::atomic<size_t> cursor{0};      // the next of them not taken, by this thread or another one
+    std::vector<node_id> settled;       // nodes of the current bucket, whose heavy edges are relaxed at its end
+    std::vector<Request> requests;
+    std::vector<std::vector<node_id>> buckets;   // cyclic: bucket i is buckets[i % buckets.size()]
+  };
+
+  /**
+   * @class DeltaStepping::Barrier
+   * @brief Blocks threads until all of them have arrived
+   */
+  class Barrier {
+  public:
+    explicit Barrier(unsigned count) : count(count) {}
+    void wait();
+  private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    unsigned count;
+    unsigned waiting = 0;
+    uint64_t generation = 0;
+  };
+
+  enum class Phase { start, light, heavy, apply, done };
+
+  // The edges with the light ones of each node first: node v's are [offsets[v], offsets[v + 1]), of which
+  // [offsets[v], heavy[v]) are light
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> heavy;
+  std::vector<node_id> targets;
+  std::vector<weight_type> weights;
+
+  weight_type bucket_width;
+  unsigned nthreads;
+  size_t num_buckets;
+
+  std::unique_ptr<std::atomic<weight_type>[]> distances;
+  std::unique_ptr<std::atomic<uint32_t>[]> visits;     // the last phase the node was relaxed in
+  std::unique_ptr<std::atomic<uint32_t>[]> settles;    // the last bucket the node was settled in
+  std::unique_ptr<Worker[]> workers;
+  std::vector<weight_type> result;
+
+  Barrier barrier;
+  Phase phase = Phase::done;
+  size_t source = 0;
+  bool heavy_phase = false;     // whether the requests being applied came from heavy edges
+  size_t bucket = 0;            // the index of the current bucket
+  uint32_t phase_id = 0;
+  uint32_t bucket_id = 0;
+
+  void work(unsigned t);
+  void next_phase();
+  bool take_bucket(size_t index);
+  bool take_settled();
+  void next_bucket();
+  void relax(unsigned t, bool light);
+  void apply(unsigned t);
+  static uint32_t next_id(uint32_t id, std::atomic<uint32_t>* stamps, size_t size);
+  inline size_t bucket_of(weight_type distance) const { return (size_t) (distance / bucket_width); }
+};
+
+#include <delta-stepping.cpp>
+#endif // _DELTA_STEPPING_HPP_INCLUDED
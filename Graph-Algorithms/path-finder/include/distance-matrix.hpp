@@ -0,0 +1,33 @@
+/**
+ * @file distance-matrix.hpp
+ * @brief Presents the interface of many-to-many distance tables
+ *
+ * @details One Dijkstra per source, which stops once it has settled every target, fills a row of the table, so
+ * the whole table takes sources.size() searches instead of sources.size() * targets.size() point to point ones.
+ * The rows are independent, so the sources are handed out to threads, each with a workspace of its own.
+ *
+ * With a contraction hierarchy of the graph, ContractionHierarchy::distance_matrix is much faster still.
+ */
+
+#ifndef _DISTANCE_MATRIX_HPP_INCLUDED
+#define _DISTANCE_MATRIX_HPP_INCLUDED
+
+#include "path-finder.hpp"
+
+#include <vector>
+#include <thread>
+
+/**
+ * @fn distance_matrix
+ * @brief The distances from every source to every target
+ * @tparam Graph Graph or CsrGraph
+ * @param nthreads The number of threads running the searches
+ * @return The row-major sources.size() x targets.size() matrix, with the largest weight where there is no path
+ */
+template <class Graph>
+std::vector<typename Graph::weight_type> distance_matrix(const Graph& graph, const std::vector<size_t>& sources,
+                                                         const std::vector<size_t>& targets,
+                                                         unsigned nthreads=std::thread::hardware_concurrency());
+
+#include <distance-matrix.cpp>
+#endif // _DISTANCE_MATRIX_HPP_INCLUDED
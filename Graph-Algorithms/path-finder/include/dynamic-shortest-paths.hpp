@@ -0,0 +1,102 @@
+/**
+ * @file dynamic-shortest-paths.hpp
+ * @brief Presents the interface of shortest paths from one source which are kept up to date as edges change
+ *
+ * @details When a few edge weights change (traffic, a closed road), most of the shortest path tree stays the same,
+ * so rather than running Dijkstra again, the tree is repaired where the changes reach, like Ramalingam and Reps'
+ * algorithm. The changes are collected and repaired together:
+ *
+ *  - A tree edge which got heavier or was removed invalidates the distances of its subtree (unless an edge between
+ *    the same nodes still gives the same distance). Those nodes take the best distance through an in-edge from
+ *    outside the subtree, which is why the in-edges of every node are kept.
+ *  - An edge which got lighter improves its target if it now gives a shorter path.
+ *
+ * Every node whose distance changed this way is queued, and Dijkstra runs from them until nothing improves. Only
+ * the part of the graph whose distances actually change is searched.
+ */
+
+#ifndef _DYNAMIC_SHORTEST_PATHS_HPP_INCLUDED
+#define _DYNAMIC_SHORTEST_PATHS_HPP_INCLUDED
+
+#include "graph.hpp"
+#include "path.hpp"
+#include "path-finder.hpp"
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <cstdint>
+
+/**
+ * @class DynamicShortestPaths
+ * @brief The shortest path tree from one source of a graph whose edge weights change. The changes go through it,
+ * so that it knows which edges to look at; they are made to the graph at once, and to the tree by repair.
+ * @tparam T Type of data stored in the nodes of the graph
+ * @tparam WT The type of the edge weights, which must be non-negative
+ */
+template <class T, class WT>
+class DynamicShortestPaths {
+public:
+  typedef WT weight_type;
+  static constexpr WT unreachable = std::numeric_limits<WT>::max();
+  static constexpr size_t npos = (size_t) -1;
+
+  /**
+   * @param graph The graph, which must outlive this, and whose edges must only be changed through it
+   */
+  DynamicShortestPaths(Graph<T, WT>& graph, size_t source);
+
+  DynamicShortestPaths(const DynamicShortestPaths&) = delete;
+  DynamicShortestPaths& operator=(const DynamicShortestPaths&) = delete;
+
+  /**
+   * @fn DynamicShortestPaths::update_edge_weight
+   * @brief Changes the weight of every edge from "from" to "to" in the graph
+   * @return Whether there was one
+   */
+  bool update_edge_weight(size_t from, size_t to, WT weight);
+
+  /**
+   * @fn DynamicShortestPaths::remove_edge
+   * @brief Removes every edge from "from" to "to" from the graph
+   * @return Whether there was one
+   */
+  bool remove_edge(size_t from, size_t to);
+
+  /**
+   * @fn DynamicShortestPaths::repair
+   * @brief Brings the tree up to date with the changes made since the last repair
+   * @return The number of nodes whose distance was searched again
+   */
+  size_t repair();
+
+  // As of the last repair
+  size_t source() const { return root; }
+  WT distance(size_t v) const { return distances[v]; }
+  size_t parent(size_t v) const { return parents[v]; }   // source for source itself, npos if unreachable
+  Path<size_t> path_to(size_t v) const;
+
+private:
+  typedef typename DefaultQueue<Graph<T, WT>, void>::type queue_type;
+
+  Graph<T, WT>& graph;
+  size_t root;
+  std::vector<std::vector<Edge<WT>>> in_edges;    // for each node, an Edge to the node each of its in-edges is from
+  std::vector<WT> distances;
+  std::vector<size_t> parents;
+  std::vector<std::pair<size_t, size_t>> changed;   // the node pairs whose edges changed since the last repair
+
+  // The nodes whose tree edge was invalidated, marked with the current epoch
+  std::vector<size_t> affected;
+  std::vector<uint32_t> affected_stamps;
+  uint32_t epoch = 0;
+  queue_type queue;
+
+  WT lightest_edge(size_t from, size_t to) const;
+  void mark_affected();
+  void relax(size_t v, size_t parent, WT distance);
+  bool is_affected(size_t v) const { return affected_stamps[v] == epoch; }
+};
+
+#include <dynamic-shortest-paths.cpp>
+#endif // _DYNAMIC_SHORTEST_PATHS_HPP_INCLUDED
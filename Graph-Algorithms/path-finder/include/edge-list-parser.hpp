@@ -0,0 +1,34 @@
+/**
+ * @file edge-list-parser.hpp
+ * @brief Presents the interface of a parallel parser for graphs in the text format
+ *
+ * @details The format is the one read by Graph's operator>>: the number of nodes and of edges, then one
+ * "from to weight" line per edge. Reading it through an istream takes longer than anything done with the graph
+ * afterwards, so the file is mapped into memory instead, and split into one chunk per thread at line boundaries.
+ * Each thread parses its chunk with std::from_chars (no locale, no copies) and counts the edges of each node.
+ * The counts give every thread, for every node, where its first edge of that node goes, so the threads then write
+ * their edges straight into the CSR arrays: a counting sort, with no vector growing an edge at a time. The edges
+ * of a node keep the order they have in the file, as with CsrGraph's edge list constructor.
+ */
+
+#ifndef _EDGE_LIST_PARSER_HPP_INCLUDED
+#define _EDGE_LIST_PARSER_HPP_INCLUDED
+
+#include "csr-graph.hpp"
+
+#include <string>
+#include <thread>
+
+/**
+ * @fn parse_edge_list
+ * @brief Reads a graph in the text format from a file
+ * @tparam T The type of the node data, which is default constructed
+ * @tparam WT The type of the weights, integer or floating point
+ * @param nthreads The number of threads parsing the file
+ * @throws std::runtime_error if the file can't be read or isn't a graph with as many edges as it says
+ */
+template <class T, class WT>
+CsrGraph<T, WT> parse_edge_list(const std::string& path, unsigned nthreads=std::thread::hardware_concurrency());
+
+#include <edge-list-parser.cpp>
+#endif // _EDGE_LIST_PARSER_HPP_INCLUDED
@@ -0,0 +1,121 @@
+/**
+ * @file graph-file.hpp
+ * @brief Presents the interface of the binary graph file, and of a read-only graph mapped from one
+ *
+ * @details The file holds a graph in compressed sparse row form, laid out exactly as it is searched: a header,
+ * the offsets of each node's edges, the targets and the weights of the edges, then optionally the data of each
+ * node and its coordinates. Each array starts on an 8 byte boundary. Loading it is a call to mmap: nothing is
+ * parsed or copied, and pages are only read from the file as the searches touch them, so a graph which took
+ * seconds to read from text is ready at once, and several processes mapping the same file share its memory.
+ *
+ * The header has a magic number, a version, and the sizes of the weight and node data types, so a file is only
+ * mapped as the graph type it was written as. Mapping also checks, in one pass over the offsets and the targets,
+ * that each node's edges are a range of the edge arrays and that every edge leads to a node of the graph, so a
+ * corrupt file is refused rather than read out of bounds. That pass reads the whole edge section; a caller who
+ * trusts the file can skip it to keep the mapping lazy.
+ */
+
+#ifndef _GRAPH_FILE_HPP_INCLUDED
+#define _GRAPH_FILE_HPP_INCLUDED
+
+#include "csr-graph.hpp"
+#include "coordinate.hpp"
+#include "mapped-file.hpp"
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+/**
+ * @class MappedGraph
+ * @brief A graph mapped from a binary graph file. It has the reading interface of CsrGraph, so it can be searched
+ * by PathFinder and the rest without being copied.
+ * @tparam T The type of the node data, which is stored as raw bytes
+ * @tparam WT The type of the edge weights
+ */
+template <class T, class WT>
+class MappedGraph {
+public:
+  typedef T data_type;
+  typedef WT weight_type;
+  typedef uint32_t node_id;
+  typedef typename CsrGraph<T, WT>::edge_range edge_range;
+  typedef Coordinate<double, 2> coordinate_type;
+
+  MappedGraph() = default;
+  MappedGraph(MappedGraph&& other) noexcept { *this = std::move(other); }
+  MappedGraph& operator=(MappedGraph&& other) noexcept;
+  MappedGraph(const MappedGraph&) = delete;
+  MappedGraph& operator=(const MappedGraph&) = delete;
+  ~MappedGraph() = default;
+
+  /**
+   * @fn MappedGraph::map
+   * @brief Maps a graph file into memory, read-only
+   * @param validate Whether to check the offsets and the targets of the edges, which touches all of their pages
+   */
+  static MappedGraph map(const std::string& path, bool validate=true);
+
+  /**
+   * @fn MappedGraph::save
+   * @brief Writes a graph to a file which map can read. The graph may have at most 2^32 nodes.
+   * @param node_data Whether to store the data of the nodes
+   * @param coordinates The coordinates of the nodes, if they are to be stored
+   */
+  static void save(const CsrGraph<T, WT>& graph, const std::string& path, bool node_data=false,
+                   const std::vector<coordinate_type>* coordinates=nullptr);
+
+  /**
+   * @fn MappedGraph::convert
+   * @brief Converts a graph from the text format read by Graph's operator>> (the number of nodes and of edges,
+   * then "from to weight" for each edge) to a graph file
+   */
+  static void convert(std::istream& is, const std::string& path);
+
+  size_t size() const { return header ? header->num_nodes : 0; }
+  size_t num_edges() const { return header ? header->num_edges : 0; }
+  edge_range operator[](size_t i) const {
+    return edge_range(targets + offsets[i], weights + offsets[i], offsets[i + 1] - offsets[i]);
+  }
+
+  /** The edges of node v are [edge_begin(v), edge_begin(v + 1)) in the edge arrays */
+  size_t edge_begin(size_t i) const { return offsets[i]; }
+  node_id target(size_t e) const { return targets[e]; }
+  WT weight(size_t e) const { return weights[e]; }
+
+  bool has_data() const { return node_data != nullptr; }
+  const T& data(size_t i) const { return node_data[i]; }
+  bool has_coordinates() const { return coordinates != nullptr; }
+  const coordinate_type& coordinate(size_t i) const { return coordinates[i]; }
+
+private:
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t weight_size;
+    uint32_t data_size;       // 0 if the nodes' data isn't stored
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t num_nodes;
+    uint64_t num_edges;
+  };
+
+  static constexpr uint32_t floating_weights = 1;
+  static constexpr uint32_t has_coordinate_section = 2;
+
+  MappedFile file;
+
+  const Header* header = nullptr;
+  const uint64_t* offsets = nullptr;
+  const node_id* targets = nullptr;
+  const WT* weights = nullptr;
+  const T* node_data = nullptr;
+  const coordinate_type* coordinates = nullptr;
+
+  static size_t layout(const Header& header, size_t sections[5]);
+  void attach(const char* data, size_t size, bool validate);
+};
+
+#include <graph-file.cpp>
+#endif // _GRAPH_FILE_HPP_INCLUDED
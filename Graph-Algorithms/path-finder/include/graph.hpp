@@ -19,12 +19,17 @@ public:
   typedef T data_type;
   typedef WT weight_type;
 
-  size_t size() { return nodes.size(); }
+  size_t size() const { return nodes.size(); }
   void add_node();
   void add_node(T data);
   void add_node(Node<T, WT>& node);
   void add_edge(size_t from, size_t to, WT weight);
+
+  // Change or remove every edge from "from" to "to", returning whether there was one
+  bool update_edge_weight(size_t from, size_t to, WT weight);
+  bool remove_edge(size_t from, size_t to);
   Node<T, WT>& operator[](int i);
+  const Node<T, WT>& operator[](int i) const;
 
   typedef typename std::vector<Node<T, WT>>::iterator iterator;
   typedef typename std::vector<Node<T, WT>>::const_iterator const_iterator;
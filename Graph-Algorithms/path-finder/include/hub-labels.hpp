@@ -0,0 +1,119 @@
+/**
+ * @file hub-labels.hpp
+ * @brief Presents the interface of hub labels (2-hop labels), for distance queries without a search
+ *
+ * @details Every node v gets an out-label, a list of hubs h with the distance d(v, h), and an in-label, a list of
+ * hubs h with the distance d(h, v). The labels cover every shortest path: for any s and t, some hub on a shortest
+ * path from s to t is in both the out-label of s and the in-label of t. The distance from s to t is then the
+ * smallest d(s, h) + d(h, t) over the hubs the two labels have in common, which is found by merging the two lists
+ * (sorted by hub) like in merge sort.
+ *
+ * The labels are built by pruned landmark labeling: nodes are taken from most to least important, and each one
+ * runs a Dijkstra forwards and one backwards, adding itself as a hub to the labels of the nodes it reaches. A
+ * search is pruned at nodes whose distance the labels built so far already give, so the less important a node is,
+ * the smaller its searches get. The order matters a lot for the size of the labels: nodes can be ordered by degree,
+ * or by their rank in a contraction hierarchy, which is usually much better on road networks.
+ *
+ * The labels are laid out in one contiguous block (a header, the offsets of each node's labels, then the hubs and
+ * the distances in separate arrays), which is saved to a file as is, and can be mapped back into memory.
+ */
+
+#ifndef _HUB_LABELS_HPP_INCLUDED
+#define _HUB_LABELS_HPP_INCLUDED
+
+#include "contraction-hierarchy.hpp"
+#include "mapped-file.hpp"
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <cstdint>
+
+/**
+ * @class HubLabels
+ * @brief The in- and out-labels of every node of a graph
+ * @tparam WT The type of the edge weights, which must be non-negative
+ */
+template <class WT>
+class HubLabels {
+public:
+  typedef WT weight_type;
+  typedef uint32_t hub_id;    // the position of the hub in the order the labels were built in
+
+  HubLabels() = default;
+  HubLabels(HubLabels&& other) noexcept { *this = std::move(other); }
+  HubLabels& operator=(HubLabels&& other) noexcept;
+  HubLabels(const HubLabels&) = delete;
+  HubLabels& operator=(const HubLabels&) = delete;
+  ~HubLabels() = default;
+
+  /**
+   * @fn HubLabels::build
+   * @brief Labels the nodes of a graph, in order of degree
+   * @tparam G Graph or CsrGraph
+   */
+  template <class G>
+  static HubLabels build(const G& graph);
+
+  /**
+   * @fn HubLabels::build
+   * @brief Labels the nodes of a graph, in order of their rank in a contraction hierarchy of it
+   */
+  template <class G>
+  static HubLabels build(const G& graph, const ContractionHierarchy<WT>& ch);
+
+  /**
+   * @fn HubLabels::distance
+   * @return The length of the shortest path from source to sink, or the largest WT if there is none
+   */
+  inline WT distance(size_t source, size_t sink) const;
+
+  size_t size() const { return header ? header->num_nodes : 0; }
+  size_t num_entries() const { return header ? header->out_entries + header->in_entries : 0; }
+
+  /**
+   * @fn HubLabels::save
+   * @brief Writes the labels to a file which map can read
+   */
+  void save(const std::string& path) const;
+
+  /**
+   * @fn HubLabels::map
+   * @brief Maps a file written by save into memory, read-only. Pages are only read from the file as the
+   * queries touch them, except for the offsets if they are validated.
+   * @param validate Whether to check that the offsets of each node's labels never decrease. The counts in the
+   * header and the ends of the offsets are checked either way.
+   */
+  static HubLabels map(const std::string& path, bool validate=true);
+
+private:
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t weight_size;
+    uint32_t reserved;
+    uint64_t num_nodes;
+    uint64_t out_entries;
+    uint64_t in_entries;
+  };
+
+  std::vector<uint64_t> image;    // the labels as laid out in the file, unless they are mapped
+  MappedFile file;
+
+  const Header* header = nullptr;
+  const uint64_t* out_offsets = nullptr;
+  const uint64_t* in_offsets = nullptr;
+  const hub_id* out_hubs = nullptr;
+  const WT* out_distances = nullptr;
+  const hub_id* in_hubs = nullptr;
+  const WT* in_distances = nullptr;
+
+  template <class G>
+  static HubLabels build_in_order(const G& graph, const std::vector<size_t>& order);
+  void attach(const char* data, size_t size, bool validate);
+  static inline WT intersect(const hub_id* a, const WT* a_distances, size_t na,
+                             const hub_id* b, const WT* b_distances, size_t nb);
+};
+
+#include <hub-labels.cpp>
+#endif // _HUB_LABELS_HPP_INCLUDED
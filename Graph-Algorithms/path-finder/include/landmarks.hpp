@@ -0,0 +1,95 @@
+/**
+ * @file landmarks.hpp
+ * @brief Presents the interface of the ALT (A*, landmarks and triangle inequality) heuristic
+ *
+ * @details A handful of landmark nodes are picked, and the distances from each landmark to every node and from
+ * every node to each landmark are precomputed. By the triangle inequality, for any landmark L
+ *
+ *   d(v, t) >= d(v, L) - d(t, L)   and   d(v, t) >= d(L, t) - d(L, v)
+ *
+ * so the largest of these differences is a lower bound on the distance from v to t. Unlike a geometric
+ * heuristic it doesn't need coordinates, and it is tight whenever a landmark lies "behind" t or v, which makes it
+ * work just as well when weights are travel times rather than lengths. The bound is consistent, so it can be
+ * used by bidirectional A* as well.
+ *
+ * Landmarks are picked one at a time, far away from the ones picked before: "farthest" takes the node furthest
+ * from all of them, "avoid" grows a shortest path tree from a random node and descends into the subtree whose
+ * distances the current landmarks bound worst. The distances from each landmark are needed to pick the next one,
+ * so those searches run one after the other; the searches towards the landmarks are independent and run in
+ * parallel. Distances are stored as uint32, node by node, so the bounds for one node are next to each other.
+ */
+
+#ifndef _LANDMARKS_HPP_INCLUDED
+#define _LANDMARKS_HPP_INCLUDED
+
+#include "path-finder.hpp"
+#include "csr-graph.hpp"
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <thread>
+
+/**
+ * @class Landmarks
+ * @brief The precomputed distances to and from a set of landmarks
+ * @tparam WT The type of the edge weights, which must be non-negative integers
+ */
+template <class WT>
+class Landmarks {
+public:
+  typedef uint32_t distance_type;
+  static constexpr distance_type unreachable = std::numeric_limits<distance_type>::max();
+
+  enum class Selection { farthest, avoid };
+
+  Landmarks() = default;
+
+  /**
+   * @fn Landmarks::build
+   * @brief Picks count landmarks of a graph and computes the distances to and from them
+   * @tparam G Graph or CsrGraph
+   * @param nthreads The number of threads running the searches towards the landmarks
+   * @param seed Seeds the random start of the selection
+   */
+  template <class G>
+  static Landmarks build(const G& graph, size_t count, Selection selection=Selection::avoid,
+                         unsigned nthreads=std::thread::hardware_concurrency(), uint64_t seed=0);
+
+  /**
+   * @fn Landmarks::lower_bound
+   * @return A lower bound on the distance from node "from" to node "to"
+   */
+  inline double lower_bound(size_t from, size_t to) const;
+
+  size_t size() const { return landmarks.size(); }
+  size_t num_nodes() const { return count == 0 ? 0 : from_landmark.size() / count; }
+  size_t landmark(size_t i) const { return landmarks[i]; }
+
+  // The distance from landmark i to node v, and from node v to landmark i, or unreachable
+  distance_type distance_from(size_t i, size_t v) const { return from_landmark[v * count + i]; }
+  distance_type distance_to(size_t i, size_t v) const { return to_landmark[v * count + i]; }
+
+private:
+  size_t count = 0;
+  std::vector<size_t> landmarks;
+  std::vector<distance_type> from_landmark;   // [v * count + i] is the distance from landmark i to v
+  std::vector<distance_type> to_landmark;     // [v * count + i] is the distance from v to landmark i
+};
+
+/**
+ * @class LandmarkHeuristic
+ * @brief The heuristic of PathFinder and BidirectionalPathFinder for ALT. It refers to the landmarks rather than
+ * copying them, so they must outlive it.
+ */
+template <class WT>
+class LandmarkHeuristic {
+public:
+  explicit LandmarkHeuristic(const Landmarks<WT>& landmarks) : landmarks(&landmarks) {}
+  double operator()(size_t from, size_t to) const { return landmarks->lower_bound(from, to); }
+private:
+  const Landmarks<WT>* landmarks;
+};
+
+#include <landmarks.cpp>
+#endif // _LANDMARKS_HPP_INCLUDED
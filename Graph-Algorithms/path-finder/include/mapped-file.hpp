@@ -0,0 +1,81 @@
+/**
+ * @file mapped-file.hpp
+ * @brief A file mapped into memory, read-only, for the graph and label files and the text parsers
+ */
+
+#ifndef _MAPPED_FILE_HPP_INCLUDED
+#define _MAPPED_FILE_HPP_INCLUDED
+
+#include <string>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * @class MappedFile
+ * @brief Owns the read-only mapping of a whole file, which stays at the same address when this is moved
+ */
+class MappedFile {
+public:
+  MappedFile() = default;
+
+  /**
+   * @param shared Whether the mapping is MAP_SHARED, so that processes mapping the same file share its pages,
+   * or MAP_PRIVATE
+   */
+  explicit MappedFile(const std::string& path, bool shared=true) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("couldn't open " + path);
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+      close(fd);
+      throw std::runtime_error("couldn't read " + path);
+    }
+    void* mapping = MAP_FAILED;
+    if (st.st_size > 0) mapping = mmap(nullptr, st.st_size, PROT_READ, shared ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (st.st_size > 0 && mapping == MAP_FAILED) throw std::runtime_error("couldn't map " + path);
+    if (st.st_size > 0) {
+      bytes = (const char*) mapping;
+      length = st.st_size;
+    }
+  }
+
+  MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+  MappedFile& operator=(MappedFile&& other) noexcept {
+    if (this == &other) return *this;
+    unmap();
+    bytes = other.bytes;
+    length = other.length;
+    other.bytes = nullptr;
+    other.length = 0;
+    return *this;
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() { unmap(); }
+
+  /** Passes a hint such as MADV_SEQUENTIAL about how the file will be read on to madvise */
+  void advise(int advice) const {
+    if (length) madvise((void*) bytes, length, advice);
+  }
+
+  const char* data() const { return bytes; }   // nullptr for an empty file
+  size_t size() const { return length; }
+  const char* begin() const { return bytes; }
+  const char* end() const { return bytes + length; }
+
+private:
+  const char* bytes = nullptr;
+  size_t length = 0;
+
+  void unmap() {
+    if (bytes) munmap((void*) bytes, length);
+  }
+};
+
+#endif // _MAPPED_FILE_HPP_INCLUDED
@@ -0,0 +1,323 @@
+/**
+ * @file monotone-queue.hpp
+ * @brief Presents priority queues for integer priorities which never go below the last popped priority
+ *
+ * @details Dijkstra's algorithm with non-negative integer weights only ever pushes priorities (distances)
+ * no smaller than the one it just popped, so it can use a queue built on buckets instead of comparisons.
+ * Two are provided, with the same interface as priority_queue<size_t> ordered by an array of keys:
+ *
+ * radix_heap: bucket i holds the keys which first differ from the last popped key at bit i - 1, so there are
+ * only as many buckets as bits in a key. Popping from an empty bucket 0 redistributes the next non-empty
+ * bucket into lower ones, and each key can only move down O(log C) times, where C is the largest edge weight.
+ *
+ * bucket_queue: Dial's algorithm, with one bucket per key in a circular array that spans the keys in the
+ * queue (at most C + 1 of them). Best when C is small.
+ *
+ * Like priority_queue, elements are size_t ids (e.g. node ids) whose keys are stored in an array outside of
+ * the queue. After lowering the key of a queued id, decrease_key moves it to its new bucket in O(1).
+ */
+
+#ifndef _MONOTONE_QUEUE_INCLUDED_HPP
+#define _MONOTONE_QUEUE_INCLUDED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include <algorithm>
+
+/**
+ * @class bucket_positions
+ * @detail Base class of the bucket based queues, keeping track of which bucket each id is in and where
+ */
+class bucket_positions {
+public:
+  /**
+   * @fn bucket_positions::contains
+   * @param value The id to look for
+   * @return True if the queue contains this id, false otherwise
+   */
+  inline bool contains(std::size_t value) const {
+    return value < bucket_of.size() && bucket_of[value] != npos;
+  }
+
+  /**
+   * @fn bucket_positions::reserve_positions
+   * @brief Makes room for ids up to (but not including) n, so that the position arrays don't grow while pushing
+   */
+  void reserve_positions(std::size_t n) {
+    if (n > bucket_of.size()) {
+      bucket_of.resize(n, npos);
+      slot_of.resize(n);
+    }
+  }
+
+protected:
+  static constexpr int32_t npos = -1;
+
+  void set_position(std::size_t value, int32_t bucket, int32_t slot) {
+    if (value >= bucket_of.size()) reserve_positions(std::max(value + 1, 2 * bucket_of.size()));
+    bucket_of[value] = bucket;
+    slot_of[value] = slot;
+  }
+  void clear_position(std::size_t value) { bucket_of[value] = npos; }
+
+  std::vector<int32_t> bucket_of;  // id -> its bucket, or npos if not in the queue
+  std::vector<int32_t> slot_of;    // id -> index in its bucket
+};
+
+/**
+ * @class radix_heap
+ * @brief Monotone priority queue of ids with integer keys, in O(log C) amortized time per element
+ * @tparam Key The (integral, non-negative) type of the keys
+ */
+template <class Key>
+class radix_heap : public bucket_positions {
+  static_assert(std::is_integral<Key>::value, "radix_heap requires integer keys");
+  typedef typename std::make_unsigned<Key>::type ukey;
+  static constexpr int nbuckets = std::numeric_limits<ukey>::digits + 1;
+
+  struct entry {
+    ukey key;
+    std::size_t value;
+  };
+
+public:
+  explicit radix_heap(const Key* keys) : keys(keys) {}
+
+  /**
+   * @fn radix_heap::top
+   * @return The id with the smallest key
+   */
+  std::size_t top() {
+    pull();
+    return buckets[0].back().value;
+  }
+
+  /**
+   * @fn radix_heap::push
+   * @brief Adds an id, whose key may not be less than the last popped key
+   */
+  void push(std::size_t value) {
+    insert({(ukey) keys[value], value});
+    count++;
+  }
+
+  /**
+   * @fn radix_heap::pop
+   * @brief Removes the id with the smallest key
+   */
+  void pop() {
+    pull();
+    clear_position(buckets[0].back().value);
+    buckets[0].pop_back();
+    count--;
+  }
+
+  /**
+   * @fn radix_heap::decrease_key
+   * @brief Moves a queued id to the bucket of its new key, which may not be less than the last popped key.
+   * Time complexity: O(1)
+   */
+  void decrease_key(std::size_t value) {
+    remove(value);
+    insert({(ukey) keys[value], value});
+  }
+
+  /**
+   * @fn radix_heap::erase
+   * @brief Removes an id from anywhere in the queue
+   */
+  void erase(std::size_t value) {
+    remove(value);
+    clear_position(value);
+    count--;
+  }
+
+  inline bool empty() const { return count == 0; }
+  inline std::size_t size() const { return count; }
+
+  /**
+   * @fn radix_heap::clear
+   * @brief Removes all ids, after which keys may start over from zero
+   */
+  void clear() {
+    for (auto& bucket : buckets) {
+      for (const entry& e : bucket) clear_position(e.value);
+      bucket.clear();
+    }
+    count = 0;
+    last = 0;
+  }
+
+private:
+  const Key* keys;
+  std::vector<entry> buckets[nbuckets];
+  ukey last = 0;          // the last key popped, which no key in the queue is less than
+  std::size_t count = 0;
+
+  inline int bucket_for(ukey key) const {
+    ukey diff = key ^ last;
+    return diff == 0 ? 0 : std::numeric_limits<unsigned long long>::digits - __builtin_clzll(diff);
+  }
+
+  inline void insert(const entry& e) {
+    int bucket = bucket_for(e.key);
+    set_position(e.value, bucket, (int32_t) buckets[bucket].size());
+    buckets[bucket].push_back(e);
+  }
+
+  // Removes an id from its bucket by moving the last one of the bucket into its place
+  inline void remove(std::size_t value) {
+    std::vector<entry>& bucket = buckets[bucket_of[value]];
+    int32_t slot = slot_of[value];
+    bucket[slot] = bucket.back();
+    slot_of[bucket[slot].value] = slot;
+    bucket.pop_back();
+  }
+
+  // Makes sure bucket 0 holds the smallest keys, by making the smallest key of the first
+  // non-empty bucket the new last key and redistributing that bucket
+  void pull() {
+    if (!buckets[0].empty()) return;
+    int i = 1;
+    while (buckets[i].empty()) ++i;
+
+    std::vector<entry> moving;
+    moving.swap(buckets[i]);
+    last = std::min_element(moving.begin(), moving.end(),
+                            [](const entry& a, const entry& b) { return a.key < b.key; })->key;
+    for (const entry& e : moving) insert(e); // all of them go to lower buckets
+    moving.clear();
+    moving.swap(buckets[i]); // hand back the capacity
+  }
+};
+
+/**
+ * @class bucket_queue
+ * @brief Monotone priority queue of ids with small integer keys (Dial's algorithm), in O(1) time per
+ * element plus the number of empty buckets passed over
+ * @tparam Key The (integral, non-negative) type of the keys
+ */
+template <class Key>
+class bucket_queue : public bucket_positions {
+  static_assert(std::is_integral<Key>::value, "bucket_queue requires integer keys");
+  typedef typename std::make_unsigned<Key>::type ukey;
+
+public:
+  explicit bucket_queue(const Key* keys) : keys(keys), buckets(initial_buckets), mask(initial_buckets - 1) {}
+
+  /**
+   * @fn bucket_queue::top
+   * @return The id with the smallest key
+   */
+  std::size_t top() {
+    advance();
+    return buckets[cursor & mask].back();
+  }
+
+  /**
+   * @fn bucket_queue::push
+   * @brief Adds an id, whose key may not be less than the last popped key
+   */
+  void push(std::size_t value) {
+    insert(value);
+    count++;
+  }
+
+  /**
+   * @fn bucket_queue::pop
+   * @brief Removes the id with the smallest key
+   */
+  void pop() {
+    advance();
+    std::vector<std::size_t>& bucket = buckets[cursor & mask];
+    clear_position(bucket.back());
+    bucket.pop_back();
+    count--;
+  }
+
+  /**
+   * @fn bucket_queue::decrease_key
+   * @brief Moves a queued id to the bucket of its new key. Time complexity: O(1)
+   */
+  void decrease_key(std::size_t value) {
+    remove(value);
+    insert(value);
+  }
+
+  /**
+   * @fn bucket_queue::erase
+   * @brief Removes an id from anywhere in the queue
+   */
+  void erase(std::size_t value) {
+    remove(value);
+    clear_position(value);
+    count--;
+  }
+
+  inline bool empty() const { return count == 0; }
+  inline std::size_t size() const { return count; }
+
+  /**
+   * @fn bucket_queue::clear
+   * @brief Removes all ids, after which keys may start over from zero
+   */
+  void clear() {
+    for (auto& bucket : buckets) {
+      for (std::size_t value : bucket) clear_position(value);
+      bucket.clear();
+    }
+    count = 0;
+    cursor = 0;
+  }
+
+private:
+  static constexpr std::size_t initial_buckets = 64;
+
+  const Key* keys;
+  std::vector<std::vector<std::size_t>> buckets;  // circular, one key per bucket, power of two many
+  std::size_t mask;
+  ukey cursor = 0;        // the last key popped: keys in the queue are in [cursor, cursor + buckets.size())
+  std::size_t count = 0;
+
+  inline void insert(std::size_t value) {
+    ukey key = (ukey) keys[value];
+    if (key - cursor > mask) grow(key - cursor + 1);
+    std::vector<std::size_t>& bucket = buckets[key & mask];
+    set_position(value, (int32_t) (key & mask), (int32_t) bucket.size());
+    bucket.push_back(value);
+  }
+
+  inline void remove(std::size_t value) {
+    std::vector<std::size_t>& bucket = buckets[bucket_of[value]];
+    int32_t slot = slot_of[value];
+    bucket[slot] = bucket.back();
+    slot_of[bucket[slot]] = slot;
+    bucket.pop_back();
+  }
+
+  inline void advance() {
+    while (buckets[cursor & mask].empty()) ++cursor;
+  }
+
+  // Widens the circular array to span at least span keys, moving each id to its bucket in the new array
+  void grow(std::size_t span) {
+    std::size_t n = buckets.size();
+    while (n < span) n *= 2;
+
+    std::vector<std::vector<std::size_t>> old(n);
+    old.swap(buckets);
+    mask = n - 1;
+    for (auto& bucket : old) {
+      for (std::size_t value : bucket) {
+        std::size_t index = (ukey) keys[value] & mask;
+        set_position(value, (int32_t) index, (int32_t) buckets[index].size());
+        buckets[index].push_back(value);
+      }
+    }
+  }
+};
+
+#endif //_MONOTONE_QUEUE_INCLUDED_HPP
@@ -23,7 +23,7 @@ public:
   void add_edge(const Edge<WT> &edge);
   void add_edge(int weight, size_t to);
   void remove_edge(int i);
-  size_t num_edges() { return edges.size(); }
+  size_t num_edges() const { return edges.size(); }
   Edge<WT>& operator[](int i);
 
   typedef typename std::vector<Edge<WT>>::iterator iterator;
@@ -0,0 +1,27 @@
+/**
+ * @file parallel.hpp
+ * @brief Runs a function on several threads at once
+ */
+
+#ifndef _PARALLEL_HPP_INCLUDED
+#define _PARALLEL_HPP_INCLUDED
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+/**
+ * @fn run_threads
+ * @brief Calls work(t) for t in [0, nthreads), each on a thread of its own, with the calling thread as thread 0,
+ * and waits for all of them to finish
+ */
+template <class Work>
+static void run_threads(unsigned nthreads, Work work) {
+  nthreads = std::max(1u, nthreads);
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < nthreads; ++t) threads.emplace_back(work, t);
+  work(0u);
+  for (std::thread& thread : threads) thread.join();
+}
+
+#endif // _PARALLEL_HPP_INCLUDED
@@ -10,12 +10,15 @@
 #include "node.hpp"
 #include "path.hpp"
 #include "priority-queue.hpp"
+#include "monotone-queue.hpp"
 #include "type-traits.hpp"
 
 #include <set>
 #include <algorithm>
 #include <limits>
 #include <vector>
+#include <cstdint>
+#include <type_traits>
 
 
 template <class T>
@@ -27,16 +30,27 @@ static inline void set_all(T* arr, T val, size_t count);
  * @tparam priority: The type of the priorities that are compared
  */
 template <class priority>
-struct ComparePriorities : public std::binary_function<size_t, size_t, bool> {
+struct ComparePriorities {
 public:
   ComparePriorities() : priorities(nullptr) {}
   explicit ComparePriorities(const priority* priorities) : priorities(priorities) {}
-  bool operator()(size_t a, size_t b) {
+  bool operator()(size_t a, size_t b) const {
     return priorities[a] < priorities[b];
   }
-  priority* priorities;
+  const priority* priorities;
 };
 
+/**
+ * @fn make_queue
+ * @brief Creates a queue of node ids ordered by an array of priorities. The monotone queues take the
+ * priorities themselves, the heap a comparison of them.
+ */
+template <class Queue, class priority>
+static inline Queue make_queue(const priority* priorities) {
+  if constexpr (std::is_constructible<Queue, const priority*>::value) return Queue(priorities);
+  else return Queue(ComparePriorities<priority>(priorities));
+}
+
 template <class Graph, class Heuristic>
 class AstarPathFinderBase {
 public:
@@ -45,6 +59,29 @@ public:
 protected:
   Heuristic heuristic;
   double* priorities = nullptr;
+
+  // The heuristic either knows the sink already, or is told it (like those of BidirectionalPathFinder)
+  inline double estimate(size_t v, size_t sink) {
+    if constexpr (std::is_invocable<Heuristic&, size_t, size_t>::value) return heuristic(v, sink);
+    else {
+      (void) sink;
+      return heuristic(v);
+    }
+  }
+};
+
+/**
+ * @class DefaultQueue
+ * @brief Picks the queue PathFinder uses by default: Dijkstra with integer weights only ever pushes
+ * distances no less than the last one popped, so it gets a radix heap, and everything else gets a binary heap
+ */
+template <class Graph, class Heuristic>
+struct DefaultQueue {
+  static constexpr bool use_Astar = !std::is_void<Heuristic>::value;
+  typedef typename if_<use_Astar, double, typename Graph::weight_type>::value priority_type;
+  typedef typename if_<!use_Astar && std::is_integral<priority_type>::value,
+    radix_heap<priority_type>,
+    priority_queue<size_t, true, ComparePriorities<priority_type>>>::value type;
 };
 
 /**
@@ -52,9 +89,12 @@ protected:
  * @brief  Provides functionality for path finding in directed, weighted graphs
  * @tparam T  Type of data stored in the nodes of the graph
  * @tparam WT The type of data stored in the weights of the graphs
- * @tparam Heuristic The type of function used to get a heuristic
+ * @tparam Heuristic The type of function used to get a heuristic: heuristic(v) for the distance from v to the
+ * sink it was made for, or heuristic(v, sink) (like LandmarkHeuristic)
+ * @tparam Queue The priority queue of node ids, ordered by an array of priorities: priority_queue<size_t>
+ * with ComparePriorities, or one of the monotone queues (radix_heap, bucket_queue) for integer weights
  */
-template <class Graph, class Heuristic=void>
+template <class Graph, class Heuristic=void, class Queue=typename DefaultQueue<Graph, Heuristic>::type>
 class PathFinder : public if_<std::is_void<Heuristic>::value, Empty, AstarPathFinderBase<Graph, Heuristic>>::value {
 public:
   static constexpr bool use_Astar = !std::is_void<Heuristic>::value;
@@ -62,59 +102,122 @@ public:
   typedef typename Graph::data_type value_type;
   typedef typename Graph::weight_type weight_type;
   typedef typename if_<use_Astar, double, weight_type>::value priority_type;
+  typedef Queue queue_type;
 
-  explicit PathFinder(size_t data_size=0) : data_size(data_size) {
-    prevs = (size_t*) malloc(data_size * sizeof(size_t));
-    distances = (weight_type*) malloc(data_size * sizeof(weight_type));
-    if constexpr (use_Astar) this->priorities = (weight_type*) malloc(data_size * sizeof(weight_type));
+  explicit PathFinder(size_t data_size=0) : queue(make_queue<queue_type, priority_type>(nullptr)) {
+    setup_arrays(data_size);
   }
 
   template <bool enable=use_Astar>
   explicit PathFinder(const typename std::enable_if<enable, Heuristic>::type& heuristic, size_t data_size=0)
-    : AstarPathFinderBase<Graph, Heuristic>(heuristic) {
-    this->data_size = data_size;
-    prevs = (size_t*) malloc(data_size * sizeof(size_t));
-    distances = (weight_type*) malloc(data_size * sizeof(weight_type));
-    if constexpr (use_Astar)
-      this->priorities = (priority_type*) malloc(data_size * sizeof(priority_type));
+    : AstarPathFinderBase<Graph, Heuristic>(heuristic), queue(make_queue<queue_type, priority_type>(nullptr)) {
+    setup_arrays(data_size);
   }
 
-  Path<size_t> find_path(Graph graph, size_t source, size_t sink) {
-
-    setup_arrays(graph.size());
-    distances[source] = 0;
-
-    ComparePriorities<priority_type> cmp;
-    if constexpr (use_Astar) cmp.priorities = this->priorities;
-    else cmp.priorities = distances; // in dijkstra's path distance *is* priority
-
-    priority_queue<size_t, true, ComparePriorities<priority_type>> queue(cmp);
-    queue.push(source);
+  PathFinder(const PathFinder&) = delete;
+  PathFinder& operator=(const PathFinder&) = delete;
 
-    while (!queue.empty()) {
-      size_t v = queue.top();
-      if (v == sink) return make_path(source, sink);
-      queue.pop();
-      for (Edge<weight_type> edge : graph[v]) {
-        weight_type alt_distance = distances[v] + edge.weight;
+  Path<size_t> find_path(const Graph& graph, size_t source, size_t sink) {
+    if (search(graph, &source, 1, sink, [sink](size_t v) { return v == sink; })) return make_path(source, sink);
+    Path<size_t> path;
+    return path; // return empty path - no path found
+  }
 
-        if (alt_distance < distances[edge.to]) { // found a faster way to get to this node
-          if (queue.contains(edge.to)) queue.erase(edge.to); // need to remove in order to update it
+  /**
+   * @struct PathFinder::Nearest
+   * @brief The source or target find_nearest_source or find_nearest_target picked, and the path to or from it
+   */
+  struct Nearest {
+    size_t index = npos;    // its position in the list it was picked from, or npos if none can be reached
+    size_t node = npos;
+    Path<size_t> path;      // empty if none can be reached
+  };
 
-          prevs[edge.to] = v; // Mark the new predecessor
+  /**
+   * @fn PathFinder::find_nearest_source
+   * @brief Finds the source closest to sink, such as the nearest depot, with one search which starts from all
+   * the sources at once
+   */
+  Nearest find_nearest_source(const Graph& graph, const std::vector<size_t>& sources, size_t sink) {
+    Nearest nearest;
+    if (!search(graph, sources.data(), sources.size(), sink, [sink](size_t v) { return v == sink; })) return nearest;
+    size_t source = sink;
+    while (prevs[source] != source) source = prevs[source];
+    nearest.index = std::find(sources.begin(), sources.end(), source) - sources.begin();
+    nearest.node = source;
+    nearest.path = make_path(source, sink);
+    return nearest;
+  }
 
-          distances[edge.to] = alt_distance;
-          if constexpr (use_Astar) this->priorities[edge.to] = alt_distance + this->heuristic(edge.to);
+  /**
+   * @fn PathFinder::find_nearest_target
+   * @brief Finds the target closest to source, stopping at the first one the search settles (Dijkstra only)
+   */
+  Nearest find_nearest_target(const Graph& graph, size_t source, const std::vector<size_t>& targets) {
+    static_assert(!use_Astar, "A* searches towards one sink");
+    Nearest nearest;
+    setup_arrays(graph.size());
+    if (++target_mark == 0) { // wrapped around: old marks could look current
+      set_all(target_marks, (uint32_t) 0, data_size);
+      target_mark = 1;
+    }
+    for (size_t target : targets) target_marks[target] = target_mark;
+    if (!search(graph, &source, 1, source, [this](size_t v) { return target_marks[v] == target_mark; }))
+      return nearest;
+    size_t target = queue.top();
+    nearest.index = std::find(targets.begin(), targets.end(), target) - targets.begin();
+    nearest.node = target;
+    nearest.path = make_path(source, target);
+    return nearest;
+  }
 
-          queue.push(edge.to); // Queue the node for processing
-        }
-      }
+  /**
+   * @fn PathFinder::shortest_path_tree
+   * @brief Finds the shortest paths from source to every node (Dijkstra only). The output vectors are only
+   * resized if they are too small, so reusing them doesn't allocate.
+   * @param distances_out Receives the distance to each node, or the largest weight_type if it can't be reached
+   * @param prevs_out Receives the node before each one on its shortest path, source for source itself, and npos
+   * if it can't be reached
+   */
+  void shortest_path_tree(const Graph& graph, size_t source, std::vector<weight_type>& distances_out,
+                          std::vector<size_t>& prevs_out) {
+    static_assert(!use_Astar, "A* searches towards one sink");
+    search(graph, &source, 1, source, [](size_t) { return false; });
+    distances_out.resize(graph.size());
+    prevs_out.resize(graph.size());
+    for (size_t v = 0; v < graph.size(); ++v) {
+      distances_out[v] = distance(v);
+      prevs_out[v] = stamps[v] == epoch ? prevs[v] : npos;
     }
+  }
 
-    Path<size_t> path;
-    return path; // return empty path - no path found
+  /**
+   * @fn PathFinder::within
+   * @brief Finds every node at most budget away from source, such as for an isochrone (Dijkstra only). The
+   * search stops as soon as the closest node left is further than budget, so only the nodes reached are touched.
+   * @return The nodes within budget, in order of distance, which distance_to gives for each of them. Valid until
+   * the next search.
+   */
+  const std::vector<size_t>& within(const Graph& graph, size_t source, weight_type budget) {
+    static_assert(!use_Astar, "A* searches towards one sink");
+    settled.clear();
+    search(graph, &source, 1, source, [this, budget](size_t v) {
+      if (distances[v] > budget) return true;
+      settled.push_back(v);
+      return false;
+    });
+    return settled;
   }
 
+  /**
+   * @fn PathFinder::distance_to
+   * @return The distance from the source of the last search to a node it settled, or the largest weight_type
+   * if it didn't reach the node
+   */
+  weight_type distance_to(size_t v) const { return distance(v); }
+
+  static constexpr size_t npos = (size_t) -1;
+
   Path<size_t> make_path(size_t start, size_t end) {
     Path<size_t> path;
     for (size_t v = end; v != start; v = prevs[v]) path.nodes.push_back(v);
@@ -126,21 +229,108 @@ public:
   ~PathFinder() {
     free(prevs);
     free(distances);
+    free(stamps);
+    free(target_marks);
     if constexpr (use_Astar) free(this->priorities);
   }
 
 private:
   size_t data_size = 0;
-  size_t* prevs;
-  weight_type* distances;
+
+  // Instead of resetting every distance before each search, a node's distance only counts if its
+  // stamp is the current epoch, so starting a new search is O(1) rather than O(nodes)
+  size_t* prevs = nullptr;
+  weight_type* distances = nullptr;
+  uint32_t* stamps = nullptr;
+  uint32_t epoch = 0;
+  queue_type queue;
+
+  std::vector<size_t> settled;   // the result of within, kept to reuse its memory
+
+  // The targets of find_nearest_target are the nodes marked with the current target_mark
+  uint32_t* target_marks = nullptr;
+  uint32_t target_mark = 0;
+
+  /**
+   * @fn PathFinder::search
+   * @brief Settles nodes in order of priority until stop(v) is true of the next one, which is left in the queue.
+   * The sources all start at distance 0, as their own predecessors.
+   * @return Whether it stopped before running out of nodes
+   */
+  template <class Stop>
+  bool search(const Graph& graph, const size_t* sources, size_t num_sources, size_t sink, Stop stop) {
+    start_search(graph.size());
+    for (size_t i = 0; i < num_sources; ++i) {
+      size_t source = sources[i];
+      if (queue.contains(source)) continue; // listed twice
+      set_distance(source, 0);
+      prevs[source] = source;
+      if constexpr (use_Astar) this->priorities[source] = this->estimate(source, sink);
+      queue.push(source);
+    }
+
+    while (!queue.empty()) {
+      size_t v = queue.top();
+      if (stop(v)) return true;
+      queue.pop();
+      for (Edge<weight_type> edge : graph[v]) {
+        weight_type alt_distance = distances[v] + edge.weight;
+
+        if (alt_distance < distance(edge.to)) { // found a faster way to get to this node
+          prevs[edge.to] = v; // Mark the new predecessor
+
+          set_distance(edge.to, alt_distance);
+          if constexpr (use_Astar) this->priorities[edge.to] = alt_distance + this->estimate(edge.to, sink);
+          else (void) sink;
+
+          // The priority only went down, so a queued node just moves up in place
+          if (queue.contains(edge.to)) queue.decrease_key(edge.to);
+          else queue.push(edge.to); // Queue the node for processing
+        }
+      }
+    }
+    return false;
+  }
+
+  inline weight_type distance(size_t v) const {
+    return stamps[v] == epoch ? distances[v] : std::numeric_limits<weight_type>::max();
+  }
+
+  inline void set_distance(size_t v, weight_type distance) {
+    distances[v] = distance;
+    stamps[v] = epoch;
+  }
+
+  void start_search(size_t graph_size) {
+    setup_arrays(graph_size);
+    queue.clear(); // left over from a search which stopped at its sink
+    if (++epoch == 0) { // wrapped around: old stamps could look current
+      set_all(stamps, (uint32_t) 0, data_size);
+      epoch = 1;
+    }
+  }
+
   void setup_arrays(size_t new_size) {
-    if (new_size <= data_size) return;
-    data_size = new_size;
+    if (new_size <= data_size && stamps != nullptr) return;
+    data_size = std::max(new_size, data_size);
     prevs = (size_t*) realloc(prevs, data_size * sizeof(size_t));
     distances = (weight_type*) realloc(distances, data_size * sizeof(weight_type));
-    if constexpr (use_Astar)
+    stamps = (uint32_t*) realloc(stamps, data_size * sizeof(uint32_t));
+    target_marks = (uint32_t*) realloc(target_marks, data_size * sizeof(uint32_t));
+    set_all(stamps, (uint32_t) 0, data_size);
+    set_all(target_marks, (uint32_t) 0, data_size);
+    epoch = 0;
+    target_mark = 0;
+
+    const priority_type* priorities;
+    if constexpr (use_Astar) {
       this->priorities = (priority_type*) realloc(this->priorities, data_size * sizeof(priority_type));
-    set_all(distances, std::numeric_limits<weight_type>::max(), data_size);
+      priorities = this->priorities;
+    } else priorities = distances; // in dijkstra's path distance *is* priority
+
+    // The arrays may have moved, so the queue has to look at the new ones
+    queue = make_queue<queue_type>(priorities);
+    queue.reserve_positions(data_size);
   }
 };
 
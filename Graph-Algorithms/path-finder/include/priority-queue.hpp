@@ -11,7 +11,9 @@
  *
  * The priority queue is implemented in two different ways. The implementation is selected using the "heap" template
  * parameter. One of these is the canonical binary heap implementation which is extended so that the queue can
- * lookup the index of an element in the heap in sub-linear time (using a map). The other implementation relies
+ * lookup the index of an element in the heap in sub-linear time (using a map). When the elements are size_t
+ * (e.g. node ids in a graph), the map is replaced by a flat array of positions indexed by the element itself,
+ * which makes the lookup O(1) and keeps it out of the allocator. The other implementation relies
  * on the underlying container (default is std::set) to provide the priority queue operations. Despite the extra
  * book-keeping and memory overhead of the binary heap + map implementation, it still performs better
  * than the implementation utilizing std::set in many cases, which is why both implementations are present.
@@ -21,6 +23,10 @@
 #define _PRIORITY_QUEUE_INCLUDED_HPP
 
 #include "type-traits.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
 #include <set>
 #include <vector>
 #include <map>
@@ -49,9 +55,54 @@ class priority_queue_base {
 public:
   priority_queue_base() = default;
 protected:
+  static constexpr int npos = -1;
+
+  int position_of(const T& value) const {
+    auto it = indices.find(value);
+    return it == indices.end() ? npos : it->second;
+  }
+  void set_position(const T& value, int index) { indices[value] = index; }
+  void clear_position(const T& value) { indices.erase(value); }
+
+private:
   std::map<T, int> indices;
 };
 
+/**
+ * @class priority_queue_base<size_t>
+ * @detail Specialization for elements which are small non-negative integers (such as node ids), where the
+ * position of each element in the heap is stored in an array indexed by the element (npos if absent)
+ */
+template <>
+class priority_queue_base<std::size_t> {
+public:
+  priority_queue_base() = default;
+
+  /**
+   * @fn priority_queue_base::reserve_positions
+   * @brief Makes room for elements up to (but not including) n, so that the array doesn't grow while pushing
+   * @param n One past the largest element that will be pushed
+   */
+  void reserve_positions(std::size_t n) {
+    if (n > positions.size()) positions.resize(n, npos);
+  }
+
+protected:
+  static constexpr int npos = -1;
+
+  int position_of(std::size_t value) const {
+    return value < positions.size() ? positions[value] : npos;
+  }
+  void set_position(std::size_t value, int index) {
+    if (value >= positions.size()) positions.resize(std::max(value + 1, 2 * positions.size()), npos);
+    positions[value] = index;
+  }
+  void clear_position(std::size_t value) { positions[value] = npos; }
+
+private:
+  std::vector<int32_t> positions;
+};
+
 /**
  * @class priority_queue
  * @brief  A priority queue that supports removal of elements for updating priorities
@@ -91,7 +142,7 @@ public:
    * @fn priority_queue::top
    * @return The element at the top (front) of the queue
    */
-  const_reference top() {
+  const_reference top() const {
     return *c.begin();
   }
 
@@ -103,7 +154,7 @@ public:
   void push(const T& value) {
     if constexpr (heap) {
       c.push_back(value);
-      bubble_up((int) size() - 1);
+      bubble_up((int) c.size() - 1);
 
     } else c.insert(value);
   }
@@ -114,9 +165,10 @@ public:
    */
   void pop() {
     if constexpr (heap) {
-      c[0] = c.back();
+      this->clear_position(c[0]);
+      T last = c.back();
       c.pop_back();
-      sink_down(0);
+      if (!c.empty()) sink_down(0, last);
 
     } else {
       if (c.empty()) return;
@@ -125,27 +177,50 @@ public:
   }
 
   /**
-   * @fn priority_queue
-   * @param value
-   * @return
+   * @fn priority_queue::erase
+   * @brief Removes an element from anywhere in the queue
+   * @param value The element to remove, which must be in the queue
    */
   void erase(const T& value) {
     if constexpr (heap) {
-      int index = this->indices[value];
-      swap(index, c.size() - 1);
+      int index = this->position_of(value);
+      this->clear_position(value);
+      T last = c.back();
       c.pop_back();
-      this->indices.erase(value);
-      sink_down(index);
+      if (index < (int) c.size()) resift(index, last);
     } else c.erase(value);
   }
 
+  /**
+   * @fn priority_queue::decrease_key
+   * @brief Restores the heap order after the priority of an element in the queue was improved
+   * (e.g. its distance in an array the comparison refers to was lowered), by moving it up in place.
+   * Only available with the heap implementation, since a set can't be re-ordered after the fact.
+   * @param value The element whose priority was improved
+   */
+  void decrease_key(const T& value) {
+    static_assert(heap, "decrease_key requires the heap implementation");
+    bubble_up(this->position_of(value), value);
+  }
+
+  /**
+   * @fn priority_queue::update
+   * @brief Restores the heap order after the priority of an element in the queue changed in either
+   * direction, by moving it up or down in place. Only available with the heap implementation.
+   * @param value The element whose priority changed
+   */
+  void update(const T& value) {
+    static_assert(heap, "update requires the heap implementation");
+    resift(this->position_of(value), value);
+  }
+
   /**
    * @fn priority_queue::contains
    * @param value The value to check for being contained in the queue
    * @return True if the queue contains this element, false otherwise
    */
-  inline bool contains(const T& value) {
-    if constexpr (heap) return this->indices.find(value) != this->indices.end();
+  inline bool contains(const T& value) const {
+    if constexpr (heap) return this->position_of(value) != this->npos;
     else return c.find(value) != c.end();
   }
 
@@ -153,7 +228,7 @@ public:
    * @fn priority_queue::empty
    * @return True if the queue is empty, false otherwise
    */
-  inline bool empty() {
+  inline bool empty() const {
     return c.empty();
   }
 
@@ -161,62 +236,69 @@ public:
    * @fn priority_queue::size
    * @return The number of elements in the priority queue
    */
-  inline size_t size() {
+  inline std::size_t size() const {
     return c.size();
   }
 
+  /**
+   * @fn priority_queue::clear
+   * @brief Removes all elements from the queue
+   */
+  void clear() {
+    if constexpr (heap) for (const T& value : c) this->clear_position(value);
+    c.clear();
+  }
+
 protected:
   Container c;
   Compare comp;
 
 private:
 
-  template <bool enable=heap>
-  typename std::enable_if<enable, int>::type
-  bubble_up(int index) {
-    if (index == 0) return 0;         // at root
-    int parent = parent_of(index);
-    if (comp(c[index], c[parent])) {
-      swap(index, parent);
-      return bubble_up(parent);
-    } else return index;
-  }
+  // The heap operations move elements into a "hole" instead of swapping them, which
+  // halves the number of writes to the container and to the positions. The value to
+  // fill the hole with is taken by copy since it may be an element of the container.
 
-  template <bool enable=heap>
-  typename std::enable_if<enable, int>::type
-  sink_down(int index) {
-    int left = left_of(index);     // Index of left child
-    int right = right_of(index);   // Index of right child
-    if (left >= (int) size()) return index;    // No children
+  inline void place(int index, const T& value) {
+    c[index] = value;
+    this->set_position(value, index);
+  }
 
-    if (comp(c[left], c[index]) && comp(c[left], c[right])) {
-      swap(left, index);
-      return sink_down(left);
-    } else if (comp(c[index], c[right]) && comp(c[right], c[left])) {
-      swap(right, index);
-      return sink_down(right);
-    } else return index; // all done!
+  void bubble_up(int hole) {
+    bubble_up(hole, c[hole]);
   }
 
-  template <bool enable=heap>
-  typename std::enable_if<enable>::type
-  inline swap(int index_a, int index_b) {
-    std::swap(c[index_a], c[index_b]);
-    this->indices[c[index_a]] = index_a;
-    this->indices[c[index_b]] = index_b;
+  void bubble_up(int hole, T value) {
+    while (hole > 0) {
+      int parent = parent_of(hole);
+      if (!comp(value, c[parent])) break;
+      place(hole, c[parent]);
+      hole = parent;
+    }
+    place(hole, value);
   }
 
-  template <bool enable=heap>
-  typename std::enable_if<enable, int>::type
-  inline left_of(int index) { return 2 * (index + 1) - 1; }
+  void sink_down(int hole, T value) {
+    int n = (int) c.size();
+    for (int left = left_of(hole); left < n; left = left_of(hole)) {
+      int right = left + 1;
+      int child = right < n && comp(c[right], c[left]) ? right : left;
+      if (!comp(c[child], value)) break;
+      place(hole, c[child]);
+      hole = child;
+    }
+    place(hole, value);
+  }
 
-  template <bool enable=heap>
-  typename std::enable_if<enable, int>::type
-  inline right_of(int index) { return 1 + left_of(index); }
+  // Fills the hole with value, which may belong either above or below it
+  void resift(int hole, T value) {
+    if (hole > 0 && comp(value, c[parent_of(hole)])) bubble_up(hole, value);
+    else sink_down(hole, value);
+  }
 
-  template <bool enable=heap>
-  typename std::enable_if<enable, int>::type
-  inline parent_of(int index) { return (index + 1) / 2 - 1; }
+  static inline int left_of(int index) { return 2 * (index + 1) - 1; }
+  static inline int right_of(int index) { return 1 + left_of(index); }
+  static inline int parent_of(int index) { return (index + 1) / 2 - 1; }
 };
 
 #endif //_PRIORITY_QUEUE_INCLUDED_HPP
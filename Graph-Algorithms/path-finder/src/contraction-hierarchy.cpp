@@ -0,0 +1,548 @@
+/**
+ * @file contraction-hierarchy.cpp
+ * @brief presents the implementation of the contraction hierarchy preprocessing and queries
+ */
+
+#ifndef _CONTRACTION_HIERARCHY_CPP_INCLUDED
+#define _CONTRACTION_HIERARCHY_CPP_INCLUDED
+
+#include <contraction-hierarchy.hpp>
+#include <parallel.hpp>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+/**
+ * @class ContractionHierarchyBuilder
+ * @brief The state of the preprocessing: the graph of the nodes which are left, and a witness search over it
+ */
+template <class WT>
+class ContractionHierarchyBuilder {
+public:
+  typedef typename ContractionHierarchy<WT>::node_id node_id;
+  typedef typename ContractionHierarchy<WT>::Options Options;
+  static constexpr node_id no_node = ContractionHierarchy<WT>::no_node;
+
+  struct ChEdge {
+    node_id node;     // the other end of the edge
+    WT weight;
+    node_id middle;   // the node a shortcut bypasses, no_node for an edge of the original graph
+  };
+
+  struct Shortcut {
+    node_id from;
+    node_id to;
+    WT weight;
+  };
+
+  template <class G>
+  ContractionHierarchyBuilder(const G& graph, const Options& options)
+    : options(options), out(graph.size()), in(graph.size()), deleted_neighbors(graph.size(), 0),
+      witness_distances(graph.size()), witness_stamps(graph.size(), 0),
+      witness_target_stamps(graph.size(), 0),
+      witness_queue(ComparePriorities<WT>(nullptr)) {
+    witness_queue = priority_queue<size_t, true, ComparePriorities<WT>>(
+      ComparePriorities<WT>(witness_distances.data()));
+    witness_queue.reserve_positions(graph.size());
+    for (size_t v = 0; v < graph.size(); ++v)
+      for (Edge<WT> edge : graph[v])
+        if (edge.to != v) add_edge((node_id) v, (node_id) edge.to, edge.weight, no_node);
+  }
+
+  /**
+   * @fn ContractionHierarchyBuilder::contract_all
+   * @brief Contracts the nodes in order of priority, moving the edges of each to the upward graphs
+   */
+  void contract_all(std::vector<node_id>& rank, std::vector<std::vector<ChEdge>>& up_out,
+                    std::vector<std::vector<ChEdge>>& up_in) {
+    size_t n = out.size();
+    rank.assign(n, no_node);
+    up_out.assign(n, {});
+    up_in.assign(n, {});
+
+    std::vector<int> priorities(n);
+    priority_queue<size_t, true, ComparePriorities<int>> queue(ComparePriorities<int>(priorities.data()));
+    queue.reserve_positions(n);
+    for (size_t v = 0; v < n; ++v) {
+      priorities[v] = priority_of((node_id) v);
+      queue.push(v);
+    }
+
+    std::vector<Shortcut> shortcuts;
+    std::vector<node_id> updated_by(n, no_node);
+    node_id next_rank = 0;
+    while (!queue.empty()) {
+      // Lazy updates: priorities of nodes whose neighborhood changed may be stale, so check the top one again
+      node_id v = (node_id) queue.top();
+      priorities[v] = priority_of(v, &shortcuts);
+      queue.update(v);
+      if (queue.top() != v) continue;
+      queue.pop();
+
+      rank[v] = next_rank++;
+      for (const ChEdge& edge : in[v]) remove_edge(out[edge.node], v);
+      for (const ChEdge& edge : out[v]) remove_edge(in[edge.node], v);
+      for (const Shortcut& shortcut : shortcuts) add_edge(shortcut.from, shortcut.to, shortcut.weight, v);
+
+      // The neighbors have one more contracted neighbor, and new shortcuts
+      for (const auto* edges : {&in[v], &out[v]}) {
+        for (const ChEdge& edge : *edges) {
+          if (updated_by[edge.node] == v) continue; // a neighbor on both sides
+          updated_by[edge.node] = v;
+          deleted_neighbors[edge.node]++;
+          priorities[edge.node] = priority_of(edge.node);
+          queue.update(edge.node);
+        }
+      }
+
+      up_out[v].swap(out[v]);
+      up_in[v].swap(in[v]);
+    }
+  }
+
+private:
+  Options options;
+  std::vector<std::vector<ChEdge>> out;   // edges between the nodes not contracted yet
+  std::vector<std::vector<ChEdge>> in;
+  std::vector<int> deleted_neighbors;
+
+  std::vector<WT> witness_distances;
+  std::vector<uint32_t> witness_stamps;
+  std::vector<uint32_t> witness_target_stamps;   // the epoch of the witness search for which a node is a target
+  uint32_t witness_epoch = 0;
+  priority_queue<size_t, true, ComparePriorities<WT>> witness_queue;
+
+  /**
+   * @fn ContractionHierarchyBuilder::add_edge
+   * @brief Adds an edge or shortcut, unless there already is an edge between the nodes which isn't longer
+   */
+  void add_edge(node_id from, node_id to, WT weight, node_id middle) {
+    for (ChEdge& edge : out[from]) {
+      if (edge.node != to) continue;
+      if (edge.weight <= weight) return;
+      edge.weight = weight;
+      edge.middle = middle;
+      for (ChEdge& reverse : in[to]) {
+        if (reverse.node != from) continue;
+        reverse.weight = weight;
+        reverse.middle = middle;
+      }
+      return;
+    }
+    out[from].push_back({to, weight, middle});
+    in[to].push_back({from, weight, middle});
+  }
+
+  static void remove_edge(std::vector<ChEdge>& edges, node_id node) {
+    for (size_t i = 0; i < edges.size(); ++i) {
+      if (edges[i].node != node) continue;
+      edges[i] = edges.back();
+      edges.pop_back();
+      return;
+    }
+  }
+
+  /**
+   * @fn ContractionHierarchyBuilder::priority_of
+   * @brief Edge difference plus deleted neighbors: nodes which add few shortcuts, and whose neighborhood
+   * hasn't been contracted much yet, are contracted first
+   * @param shortcuts If not null, receives the shortcuts contracting the node would add
+   */
+  int priority_of(node_id v, std::vector<Shortcut>* shortcuts=nullptr) {
+    std::vector<Shortcut> local;
+    std::vector<Shortcut>& result = shortcuts ? *shortcuts : local;
+    find_shortcuts(v, result);
+    int edge_difference = (int) result.size() - (int) (in[v].size() + out[v].size());
+    return options.edge_difference_weight * edge_difference + options.deleted_neighbors_weight * deleted_neighbors[v];
+  }
+
+  /**
+   * @fn ContractionHierarchyBuilder::find_shortcuts
+   * @brief Finds the pairs of neighbors u -> v -> x for which the path through v is the only shortest one
+   * (as far as the bounded witness search can tell)
+   */
+  void find_shortcuts(node_id v, std::vector<Shortcut>& shortcuts) {
+    shortcuts.clear();
+    for (const ChEdge& in_edge : in[v]) {
+      node_id u = in_edge.node;
+      WT limit = 0;
+      bool any = false;
+      for (const ChEdge& out_edge : out[v]) {
+        if (out_edge.node == u) continue;
+        limit = std::max(limit, (WT) (in_edge.weight + out_edge.weight));
+        any = true;
+      }
+      if (!any) continue;
+
+      witness_search(u, v, limit, out[v].size());
+      for (const ChEdge& out_edge : out[v]) {
+        if (out_edge.node == u) continue;
+        WT via = in_edge.weight + out_edge.weight;
+        if (witness_distance(out_edge.node) > via) shortcuts.push_back({u, out_edge.node, via});
+      }
+    }
+  }
+
+  inline WT witness_distance(size_t v) const {
+    return witness_stamps[v] == witness_epoch ? witness_distances[v] : std::numeric_limits<WT>::max();
+  }
+
+  /**
+   * @fn ContractionHierarchyBuilder::witness_search
+   * @brief Dijkstra from source over the remaining graph without avoid, up to distance limit or the settle limit,
+   * or until every out-neighbor of avoid is settled
+   */
+  void witness_search(node_id source, node_id avoid, WT limit, size_t targets) {
+    witness_queue.clear();
+    if (++witness_epoch == 0) {
+      std::fill(witness_stamps.begin(), witness_stamps.end(), 0);
+      std::fill(witness_target_stamps.begin(), witness_target_stamps.end(), 0);
+      witness_epoch = 1;
+    }
+    // Stamped rather than marked with source, which runs a search for each of its neighbors with other targets
+    for (const ChEdge& edge : out[avoid]) witness_target_stamps[edge.node] = witness_epoch;
+
+    witness_distances[source] = 0;
+    witness_stamps[source] = witness_epoch;
+    witness_queue.push(source);
+    for (size_t settled = 0; !witness_queue.empty() && settled < options.witness_settle_limit; ++settled) {
+      size_t y = witness_queue.top();
+      if (witness_distances[y] > limit) break;
+      witness_queue.pop();
+      if (witness_target_stamps[y] == witness_epoch && --targets == 0) break;
+      for (const ChEdge& edge : out[y]) {
+        if (edge.node == avoid) continue;
+        WT alt = witness_distances[y] + edge.weight;
+        if (alt >= witness_distance(edge.node)) continue;
+        witness_distances[edge.node] = alt;
+        witness_stamps[edge.node] = witness_epoch;
+        if (witness_queue.contains(edge.node)) witness_queue.decrease_key(edge.node);
+        else witness_queue.push(edge.node);
+      }
+    }
+  }
+};
+
+template <class WT>
+template <class G>
+ContractionHierarchy<WT> ContractionHierarchy<WT>::build(const G& graph, const Options& options) {
+  typedef typename ContractionHierarchyBuilder<WT>::ChEdge ChEdge;
+  ContractionHierarchy<WT> ch;
+  std::vector<std::vector<ChEdge>> up_out, up_in;
+  {
+    ContractionHierarchyBuilder<WT> builder(graph, options);
+    builder.contract_all(ch.rank, up_out, up_in);
+  }
+
+  // Flatten into the upward graphs, in compressed sparse row form
+  for (auto [edges, upward] : {std::make_pair(&up_out, &ch.forward_graph), std::make_pair(&up_in, &ch.backward_graph)}) {
+    upward->offsets.assign(1, 0);
+    for (std::vector<ChEdge>& node_edges : *edges) {
+      for (const ChEdge& edge : node_edges) {
+        upward->targets.push_back(edge.node);
+        upward->weights.push_back(edge.weight);
+        upward->middles.push_back(edge.middle);
+        if (edge.middle != no_node) ch.shortcuts++;
+      }
+      upward->offsets.push_back(upward->targets.size());
+      std::vector<ChEdge>().swap(node_edges);
+    }
+  }
+  return ch;
+}
+
+template <class WT>
+Path<size_t> ContractionHierarchy<WT>::find_path(size_t source, size_t sink) {
+  Path<size_t> path;
+  WT best;
+  node_id meeting;
+  if (!search(source, sink, best, meeting)) return path; // return empty path - no path found
+
+  // The upward path from the source to the meeting node, from the end back
+  std::vector<node_id> up;
+  for (node_id v = meeting; v != no_node; v = forward.prevs[v]) up.push_back(v);
+  std::reverse(up.begin(), up.end());
+
+  path.nodes.push_back(source);
+  for (size_t i = 0; i + 1 < up.size(); ++i) {
+    size_t e = find_edge(forward_graph, up[i], up[i + 1]);
+    unpack(up[i], up[i + 1], forward_graph.middles[e], path.nodes);
+  }
+  for (node_id v = meeting; backward.prevs[v] != no_node; v = backward.prevs[v]) {
+    node_id next = backward.prevs[v];
+    size_t e = find_edge(backward_graph, next, v);
+    unpack(v, next, backward_graph.middles[e], path.nodes);
+  }
+  return path;
+}
+
+template <class WT>
+WT ContractionHierarchy<WT>::distance(size_t source, size_t sink) {
+  WT best;
+  node_id meeting;
+  search(source, sink, best, meeting);
+  return best;
+}
+
+template <class WT>
+void ContractionHierarchy<WT>::Search::start(size_t size) {
+  if (size > stamps.size()) {
+    distances.resize(size);
+    prevs.resize(size);
+    stamps.assign(size, 0);
+    epoch = 0;
+    queue = priority_queue<size_t, true, ComparePriorities<WT>>(ComparePriorities<WT>(distances.data()));
+    queue.reserve_positions(size);
+  }
+  queue.clear();
+  if (++epoch == 0) {
+    std::fill(stamps.begin(), stamps.end(), 0);
+    epoch = 1;
+  }
+}
+
+/**
+ * @fn ContractionHierarchy::search
+ * @brief Upward searches from both ends. Each one stops once its closest unsettled node is no closer than the
+ * best path found, since the rest of its search space can only lead to longer paths.
+ * @return True if there is a path, in which case best is its length and meeting its highest ranked node
+ */
+template <class WT>
+bool ContractionHierarchy<WT>::search(size_t source, size_t sink, WT& best, node_id& meeting) {
+  forward.start(size());
+  backward.start(size());
+  best = std::numeric_limits<WT>::max();
+  meeting = no_node;
+
+  for (auto [search, start] : {std::make_pair(&forward, source), std::make_pair(&backward, sink)}) {
+    search->distances[start] = 0;
+    search->prevs[start] = no_node;
+    search->stamps[start] = search->epoch;
+    search->queue.push(start);
+  }
+
+  while (true) {
+    bool forward_active = !forward.queue.empty() && forward.distances[forward.queue.top()] < best;
+    bool backward_active = !backward.queue.empty() && backward.distances[backward.queue.top()] < best;
+    if (!forward_active && !backward_active) break;
+
+    if (forward_active &&
+        (!backward_active || forward.distances[forward.queue.top()] <= backward.distances[backward.queue.top()]))
+      settle(forward_graph, forward, backward, best, meeting);
+    else settle(backward_graph, backward, forward, best, meeting);
+  }
+  return meeting != no_node;
+}
+
+template <class WT>
+void ContractionHierarchy<WT>::settle(const UpwardGraph& graph, Search& self, const Search& other,
+                                      WT& best, node_id& meeting) {
+  node_id v = (node_id) self.queue.top();
+  self.queue.pop();
+  WT distance = self.distances[v];
+  if (other.reached(v) && distance + other.distances[v] < best) {
+    best = distance + other.distances[v];
+    meeting = v;
+  }
+
+  for (uint64_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+    node_id u = graph.targets[e];
+    WT alt = distance + graph.weights[e];
+    if (alt >= self.distance(u)) continue;
+    self.distances[u] = alt;
+    self.prevs[u] = v;
+    self.stamps[u] = self.epoch;
+    if (self.queue.contains(u)) self.queue.decrease_key(u);
+    else self.queue.push(u);
+  }
+}
+
+template <class WT>
+std::vector<WT> ContractionHierarchy<WT>::distance_matrix(const std::vector<size_t>& sources,
+                                                          const std::vector<size_t>& targets, unsigned nthreads) const {
+  struct BucketEntry {
+    uint32_t target;    // the index into targets
+    WT distance;        // from the node of the bucket to the target
+  };
+  nthreads = std::max(1u, nthreads);
+
+  // Each thread collects the buckets entries of its targets' searches, which are then sorted by node
+  std::vector<std::vector<std::pair<node_id, BucketEntry>>> found(nthreads);
+  std::atomic<size_t> next(0);
+  run_threads(nthreads, [&](unsigned t) {
+    Search search;
+    for (size_t j = next++; j < targets.size(); j = next++) {
+      upward_search(backward_graph, search, targets[j], [&](node_id v, WT distance) {
+        found[t].push_back({v, BucketEntry{(uint32_t) j, distance}});
+      });
+    }
+  });
+
+  std::vector<uint64_t> bucket_offsets(size() + 1, 0);
+  for (const auto& entries : found)
+    for (const auto& entry : entries) bucket_offsets[entry.first + 1]++;
+  for (size_t v = 0; v < size(); ++v) bucket_offsets[v + 1] += bucket_offsets[v];
+  std::vector<BucketEntry> buckets(bucket_offsets.back());
+  std::vector<uint64_t> fill(bucket_offsets.begin(), bucket_offsets.end() - 1);
+  for (auto& entries : found) {
+    for (const auto& entry : entries) buckets[fill[entry.first]++] = entry.second;
+    std::vector<std::pair<node_id, BucketEntry>>().swap(entries);
+  }
+
+  std::vector<WT> matrix(sources.size() * targets.size(), std::numeric_limits<WT>::max());
+  next = 0;
+  run_threads(nthreads, [&](unsigned) {
+    Search search;
+    for (size_t i = next++; i < sources.size(); i = next++) {
+      WT* row = matrix.data() + i * targets.size();
+      upward_search(forward_graph, search, sources[i], [&](node_id v, WT distance) {
+        for (uint64_t e = bucket_offsets[v]; e < bucket_offsets[v + 1]; ++e)
+          row[buckets[e].target] = std::min(row[buckets[e].target], (WT) (distance + buckets[e].distance));
+      });
+    }
+  });
+  return matrix;
+}
+
+/**
+ * @fn ContractionHierarchy::upward_search
+ * @brief Runs the search of one direction of a query to the end, calling settled(v, distance) for every node
+ * it settles
+ */
+template <class WT>
+template <class Settled>
+void ContractionHierarchy<WT>::upward_search(const UpwardGraph& graph, Search& search, size_t start,
+                                             Settled settled) const {
+  search.start(size());
+  search.distances[start] = 0;
+  search.prevs[start] = no_node;
+  search.stamps[start] = search.epoch;
+  search.queue.push(start);
+
+  while (!search.queue.empty()) {
+    node_id v = (node_id) search.queue.top();
+    search.queue.pop();
+    WT distance = search.distances[v];
+    settled(v, distance);
+    for (uint64_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+      node_id u = graph.targets[e];
+      WT alt = distance + graph.weights[e];
+      if (alt >= search.distance(u)) continue;
+      search.distances[u] = alt;
+      search.prevs[u] = v;
+      search.stamps[u] = search.epoch;
+      if (search.queue.contains(u)) search.queue.decrease_key(u);
+      else search.queue.push(u);
+    }
+  }
+}
+
+/**
+ * @fn ContractionHierarchy::unpack
+ * @brief Appends the nodes of the original graph on the edge from -> to (excluding from) to nodes. A shortcut
+ * bypassing middle stands for the edges from -> middle and middle -> to, which were both edges of middle
+ * when it was contracted.
+ */
+template <class WT>
+void ContractionHierarchy<WT>::unpack(node_id from, node_id to, node_id middle, std::vector<size_t>& nodes) const {
+  if (middle == no_node) {
+    nodes.push_back(to);
+    return;
+  }
+  size_t first = find_edge(backward_graph, middle, from);
+  unpack(from, middle, backward_graph.middles[first], nodes);
+  size_t second = find_edge(forward_graph, middle, to);
+  unpack(middle, to, forward_graph.middles[second], nodes);
+}
+
+template <class WT>
+size_t ContractionHierarchy<WT>::find_edge(const UpwardGraph& graph, node_id at, node_id other) {
+  for (uint64_t e = graph.offsets[at]; e < graph.offsets[at + 1]; ++e)
+    if (graph.targets[e] == other) return e;
+  throw std::logic_error("contraction hierarchy is missing an edge");
+}
+
+static const char ch_magic[4] = {'C', 'H', 'P', 'F'};
+static const uint32_t ch_version = 1;
+
+template <class T>
+static void write_vector(std::ostream& os, const std::vector<T>& v) {
+  uint64_t n = v.size();
+  os.write((const char*) &n, sizeof(n));
+  os.write((const char*) v.data(), n * sizeof(T));
+}
+
+/**
+ * @fn read_vector
+ * @brief Reads a vector written by write_vector. It grows as the elements arrive, so a corrupt length fails at the
+ * end of the stream rather than allocating for elements which aren't there.
+ */
+template <class T>
+static void read_vector(std::istream& is, std::vector<T>& v) {
+  const uint64_t chunk = (1 << 20) / sizeof(T);
+  uint64_t n = 0;
+  is.read((char*) &n, sizeof(n));
+  v.clear();
+  while (is && v.size() < n) {
+    size_t at = v.size();
+    v.resize(at + std::min(chunk, n - at));
+    is.read((char*) (v.data() + at), (v.size() - at) * sizeof(T));
+  }
+}
+
+template <class WT>
+void ContractionHierarchy<WT>::save(std::ostream& os) const {
+  os.write(ch_magic, sizeof(ch_magic));
+  uint32_t header[2] = {ch_version, (uint32_t) sizeof(WT)};
+  os.write((const char*) header, sizeof(header));
+  uint64_t num_shortcuts = shortcuts;
+  os.write((const char*) &num_shortcuts, sizeof(num_shortcuts));
+  write_vector(os, rank);
+  for (const UpwardGraph* graph : {&forward_graph, &backward_graph}) {
+    write_vector(os, graph->offsets);
+    write_vector(os, graph->targets);
+    write_vector(os, graph->weights);
+    write_vector(os, graph->middles);
+  }
+}
+
+template <class WT>
+ContractionHierarchy<WT> ContractionHierarchy<WT>::load(std::istream& is) {
+  char magic[sizeof(ch_magic)];
+  uint32_t header[2];
+  is.read(magic, sizeof(magic));
+  is.read((char*) header, sizeof(header));
+  if (!is || !std::equal(magic, magic + sizeof(magic), ch_magic) || header[0] != ch_version || header[1] != sizeof(WT))
+    throw std::runtime_error("not a contraction hierarchy of this version and weight type");
+
+  ContractionHierarchy<WT> ch;
+  uint64_t num_shortcuts = 0;
+  is.read((char*) &num_shortcuts, sizeof(num_shortcuts));
+  ch.shortcuts = num_shortcuts;
+  read_vector(is, ch.rank);
+  for (UpwardGraph* graph : {&ch.forward_graph, &ch.backward_graph}) {
+    read_vector(is, graph->offsets);
+    read_vector(is, graph->targets);
+    read_vector(is, graph->weights);
+    read_vector(is, graph->middles);
+  }
+  if (!is) throw std::runtime_error("truncated contraction hierarchy");
+
+  // The searches follow the offsets and targets without checking them
+  size_t n = ch.rank.size();
+  for (const UpwardGraph* graph : {&ch.forward_graph, &ch.backward_graph}) {
+    size_t m = graph->targets.size();
+    if (graph->offsets.size() != n + 1 || graph->offsets[0] != 0 || graph->offsets[n] != m ||
+        graph->weights.size() != m || graph->middles.size() != m)
+      throw std::runtime_error("corrupt contraction hierarchy");
+    for (size_t v = 0; v < n; ++v)
+      if (graph->offsets[v] > graph->offsets[v + 1])
+        throw std::runtime_error("corrupt contraction hierarchy: offsets out of order");
+    for (size_t e = 0; e < m; ++e)
+      if (graph->targets[e] >= n || (graph->middles[e] != no_node && graph->middles[e] >= n))
+        throw std::runtime_error("corrupt contraction hierarchy: edge to a node which doesn't exist");
+  }
+  return ch;
+}
+
+#endif // _CONTRACTION_HIERARCHY_CPP_INCLUDED
@@ -0,0 +1,78 @@
+/**
+ * @file csr-graph.cpp
+ * @brief presents the implementation of the compressed sparse row graph
+ */
+
+#ifndef _CSR_GRAPH_CPP_INCLUDED
+#define _CSR_GRAPH_CPP_INCLUDED
+
+#include <csr-graph.hpp>
+
+template <class T, class WT>
+CsrGraph<T, WT>::CsrGraph(const Graph<T, WT>& graph) {
+  size_t num_edges = 0;
+  for (const Node<T, WT>& node : graph) {
+    num_edges += node.num_edges();
+    offsets.push_back(num_edges);
+    node_data.push_back(node.data);
+  }
+
+  targets.reserve(num_edges);
+  weights.reserve(num_edges);
+  for (const Node<T, WT>& node : graph) {
+    for (const Edge<WT>& edge : node) {
+      targets.push_back((node_id) edge.to);
+      weights.push_back(edge.weight);
+    }
+  }
+}
+
+template <class T, class WT>
+CsrGraph<T, WT>::CsrGraph(size_t num_nodes, const std::vector<edge_list_entry>& edges)
+  : offsets(num_nodes + 1, 0), targets(edges.size()), weights(edges.size()), node_data(num_nodes) {
+
+  // Counting sort of the edges by source node, keeping the order of edges from the same node
+  for (const edge_list_entry& edge : edges) offsets[std::get<0>(edge) + 1]++;
+  for (size_t i = 0; i < num_nodes; ++i) offsets[i + 1] += offsets[i];
+
+  std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+  for (const edge_list_entry& edge : edges) {
+    size_t e = next[std::get<0>(edge)]++;
+    targets[e] = (node_id) std::get<1>(edge);
+    weights[e] = std::get<2>(edge);
+  }
+}
+
+template <class T, class WT>
+template <class G>
+CsrGraph<T, WT> CsrGraph<T, WT>::reverse_of(const G& graph) {
+  size_t num_nodes = graph.size();
+  CsrGraph<T, WT> reverse;
+  reverse.offsets.assign(num_nodes + 1, 0);
+  reverse.node_data.resize(num_nodes);
+
+  // Counting sort by target node
+  for (size_t v = 0; v < num_nodes; ++v)
+    for (Edge<WT> edge : graph[v]) reverse.offsets[edge.to + 1]++;
+  for (size_t i = 0; i < num_nodes; ++i) reverse.offsets[i + 1] += reverse.offsets[i];
+
+  reverse.targets.resize(reverse.offsets[num_nodes]);
+  reverse.weights.resize(reverse.offsets[num_nodes]);
+  std::vector<size_t> next(reverse.offsets.begin(), reverse.offsets.end() - 1);
+  for (size_t v = 0; v < num_nodes; ++v) {
+    for (Edge<WT> edge : graph[v]) {
+      size_t e = next[edge.to]++;
+      reverse.targets[e] = (node_id) v;
+      reverse.weights[e] = edge.weight;
+    }
+  }
+  return reverse;
+}
+
+template <class T, class WT>
+typename CsrGraph<T, WT>::edge_range CsrGraph<T, WT>::operator[](size_t i) const {
+  size_t begin = offsets[i];
+  return edge_range(targets.data() + begin, weights.data() + begin, offsets[i + 1] - begin);
+}
+
+#endif // _CSR_GRAPH_CPP_INCLUDED
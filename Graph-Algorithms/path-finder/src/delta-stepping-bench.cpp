@@ -0,0 +1,86 @@
+/**
+ * @file delta-stepping-bench.cpp
+ * @brief Times delta-stepping on 1 to 64 threads against Dijkstra, checking that the distances are the same
+ */
+
+#include "csr-graph.hpp"
+#include "delta-stepping.hpp"
+#include "monotone-queue.hpp"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cassert>
+
+using namespace std;
+
+#define NODES 1000000
+#define EDGES_PER_NODE 8
+#define MAX_WEIGHT 100
+#define SOURCES 3
+
+typedef CsrGraph<int, int> csr_graph;
+
+static double seconds_since(chrono::steady_clock::time_point begin) {
+  return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * @fn dijkstra
+ * @return The distances from source to every node, by Dijkstra with a radix heap
+ */
+static vector<int> dijkstra(const csr_graph& g, size_t source) {
+  vector<int> distances(g.size(), numeric_limits<int>::max());
+  radix_heap<int> queue(distances.data());
+  queue.reserve_positions(g.size());
+  distances[source] = 0;
+  queue.push(source);
+  while (!queue.empty()) {
+    size_t v = queue.top();
+    queue.pop();
+    for (Edge<int> edge : g[v]) {
+      int alt_distance = distances[v] + edge.weight;
+      if (alt_distance >= distances[edge.to]) continue;
+      distances[edge.to] = alt_distance;
+      if (queue.contains(edge.to)) queue.decrease_key(edge.to);
+      else queue.push(edge.to);
+    }
+  }
+  return distances;
+}
+
+int main() {
+  mt19937 rng(0);
+  vector<csr_graph::edge_list_entry> edges;
+  for (size_t v = 0; v < NODES; ++v)
+    for (int i = 0; i < EDGES_PER_NODE; ++i)
+      edges.emplace_back(v, rng() % NODES, 1 + (int) (rng() % MAX_WEIGHT));
+  csr_graph g(NODES, edges);
+  edges.clear();
+  edges.shrink_to_fit();
+
+  vector<size_t> sources;
+  vector<vector<int>> expected;
+  auto begin = chrono::steady_clock::now();
+  for (int i = 0; i < SOURCES; ++i) {
+    sources.push_back(rng() % NODES);
+    expected.push_back(dijkstra(g, sources.back()));
+  }
+  cout << "Dijkstra:\t" << seconds_since(begin) / SOURCES << " [seconds] per search" << endl;
+  cout << "Hardware threads:\t" << thread::hardware_concurrency() << endl;
+
+  // Around the weight of an edge divided by the degree is the usual choice for random weights
+  for (int delta : {MAX_WEIGHT / EDGES_PER_NODE, MAX_WEIGHT / 2, MAX_WEIGHT}) {
+    for (unsigned nthreads = 1; nthreads <= 64; nthreads *= 2) {
+      DeltaStepping<csr_graph> delta_stepping(g, delta, nthreads);
+      begin = chrono::steady_clock::now();
+      vector<vector<int>> found;
+      for (int i = 0; i < SOURCES; ++i) found.push_back(delta_stepping.run(sources[i]));
+      double elapsed = seconds_since(begin);
+      assert(found == expected);
+      cout << "Delta " << delta << ", " << nthreads << " threads:\t" << elapsed / SOURCES
+           << " [seconds] per search" << endl;
+    }
+  }
+}
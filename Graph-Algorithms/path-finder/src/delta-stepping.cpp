@@ -0,0 +1,249 @@
+/**
+ * @file delta-stepping.cpp
+ * @brief presents the implementation of parallel delta-stepping
+ */
+
+#ifndef _DELTA_STEPPING_CPP_INCLUDED
+#define _DELTA_STEPPING_CPP_INCLUDED
+
+#include <delta-stepping.hpp>
+#include <edge.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+#define DELTA_STEPPING_CHUNK 256    // nodes a thread takes from a list at a time
+
+template <class Graph>
+DeltaStepping<Graph>::DeltaStepping(const Graph& graph, weight_type delta, unsigned nthreads)
+  : bucket_width(delta), nthreads(std::max(1u, nthreads)), barrier(std::max(1u, nthreads)) {
+  if (!(delta > 0)) throw std::invalid_argument("delta must be positive");
+
+  size_t n = graph.size();
+  offsets.assign(1, 0);
+  heavy.resize(n);
+  weight_type max_weight = 0;
+  for (size_t v = 0; v < n; ++v) {
+    for (bool light : {true, false}) {
+      if (!light) heavy[v] = targets.size();
+      for (Edge<weight_type> edge : graph[v]) {
+        if ((edge.weight <= delta) != light) continue;
+        targets.push_back((node_id) edge.to);
+        weights.push_back(edge.weight);
+        max_weight = std::max(max_weight, edge.weight);
+      }
+    }
+    offsets.push_back(targets.size());
+  }
+
+  // A relaxation reaches at most max_weight past the current bucket, so this many buckets never wrap around
+  num_buckets = bucket_of(max_weight) + 2;
+
+  distances.reset(new std::atomic<weight_type>[n]);
+  visits.reset(new std::atomic<uint32_t>[n]);
+  settles.reset(new std::atomic<uint32_t>[n]);
+  for (size_t v = 0; v < n; ++v) {
+    visits[v].store(0, std::memory_order_relaxed);
+    settles[v].store(0, std::memory_order_relaxed);
+  }
+  workers.reset(new Worker[this->nthreads]);
+  for (unsigned t = 0; t < this->nthreads; ++t) workers[t].buckets.resize(num_buckets);
+  result.resize(n);
+}
+
+template <class Graph>
+const std::vector<typename Graph::weight_type>& DeltaStepping<Graph>::run(size_t source) {
+  this->source = source;
+  phase = Phase::start;
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < nthreads; ++t) threads.emplace_back(&DeltaStepping::work, this, t);
+  work(0);
+  for (std::thread& thread : threads) thread.join();
+  return result;
+}
+
+/**
+ * @fn DeltaStepping::work
+ * @brief What each thread runs. Between phases, thread 0 alone decides what the next one is.
+ */
+template <class Graph>
+void DeltaStepping<Graph>::work(unsigned t) {
+  size_t begin = size() * t / nthreads;
+  size_t end = size() * (t + 1) / nthreads;
+  for (size_t v = begin; v < end; ++v) distances[v].store(unreachable, std::memory_order_relaxed);
+  barrier.wait();
+
+  while (true) {
+    if (t == 0) next_phase();
+    barrier.wait();
+    if (phase == Phase::done) break;
+    if (phase == Phase::apply) apply(t);
+    else relax(t, phase == Phase::light);
+    barrier.wait();
+  }
+
+  for (size_t v = begin; v < end; ++v) result[v] = distances[v].load(std::memory_order_relaxed);
+}
+
+template <class Graph>
+void DeltaStepping<Graph>::next_phase() {
+  switch (phase) {
+    case Phase::start:
+      distances[source].store(0, std::memory_order_relaxed);
+      workers[0].buckets[0].push_back((node_id) source);
+      bucket = 0;
+      bucket_id = next_id(bucket_id, settles.get(), size());
+      take_bucket(bucket);
+      phase = Phase::light;
+      break;
+
+    case Phase::light:
+    case Phase::heavy:
+      heavy_phase = phase == Phase::heavy;
+      phase = Phase::apply;
+      break;
+
+    case Phase::apply:
+      if (!heavy_phase) {
+        if (take_bucket(bucket)) { // light edges put nodes back into the current bucket
+          phase = Phase::light;
+          break;
+        }
+        if (take_settled()) {
+          phase = Phase::heavy;
+          break;
+        }
+      }
+      next_bucket();
+      break;
+
+    default:
+      break;
+  }
+}
+
+/**
+ * @fn DeltaStepping::take_bucket
+ * @brief Hands each thread the nodes it put into a bucket, as its list for the next light phase
+ * @return Whether the bucket had any nodes
+ */
+template <class Graph>
+bool DeltaStepping<Graph>::take_bucket(size_t index) {
+  bool any = false;
+  for (unsigned t = 0; t < nthreads; ++t) {
+    Worker& worker = workers[t];
+    worker.frontier.clear();
+    worker.frontier.swap(worker.buckets[index % num_buckets]);
+    worker.cursor.store(0, std::memory_order_relaxed);
+    any |= !worker.frontier.empty();
+  }
+  if (any) phase_id = next_id(phase_id, visits.get(), size());
+  return any;
+}
+
+template <class Graph>
+bool DeltaStepping<Graph>::take_settled() {
+  bool any = false;
+  for (unsigned t = 0; t < nthreads; ++t) {
+    Worker& worker = workers[t];
+    worker.frontier.clear();
+    worker.frontier.swap(worker.settled);
+    worker.cursor.store(0, std::memory_order_relaxed);
+    any |= !worker.frontier.empty();
+  }
+  return any;
+}
+
+template <class Graph>
+void DeltaStepping<Graph>::next_bucket() {
+  for (size_t k = 1; k < num_buckets; ++k) {
+    if (take_bucket(bucket + k)) {
+      bucket += k;
+      bucket_id = next_id(bucket_id, settles.get(), size());
+      phase = Phase::light;
+      return;
+    }
+  }
+  phase = Phase::done;
+}
+
+/**
+ * @fn DeltaStepping::relax
+ * @brief Goes over the light edges of the nodes of the current bucket, or the heavy edges of those settled in it,
+ * and collects requests for the ones which could lower a distance. Once its own list is done, a thread helps
+ * with the others'.
+ */
+template <class Graph>
+void DeltaStepping<Graph>::relax(unsigned t, bool light) {
+  Worker& self = workers[t];
+  for (unsigned k = 0; k < nthreads; ++k) {
+    Worker& victim = workers[(t + k) % nthreads];
+    size_t size = victim.frontier.size();
+    size_t begin;
+    while ((begin = victim.cursor.fetch_add(DELTA_STEPPING_CHUNK, std::memory_order_relaxed)) < size) {
+      size_t end = std::min(begin + DELTA_STEPPING_CHUNK, size);
+      for (size_t i = begin; i < end; ++i) {
+        node_id v = victim.frontier[i];
+        weight_type distance = distances[v].load(std::memory_order_relaxed);
+        uint64_t first = offsets[v], last = heavy[v];
+        if (light) {
+          if (bucket_of(distance) != bucket) continue; // moved to an earlier bucket since it was put here
+          if (visits[v].exchange(phase_id, std::memory_order_relaxed) == phase_id) continue; // here twice
+          if (settles[v].exchange(bucket_id, std::memory_order_relaxed) != bucket_id) self.settled.push_back(v);
+        } else {
+          first = heavy[v];
+          last = offsets[v + 1];
+        }
+
+        for (uint64_t e = first; e < last; ++e) {
+          weight_type alt_distance = distance + weights[e];
+          if (alt_distance < distances[targets[e]].load(std::memory_order_relaxed))
+            self.requests.push_back({targets[e], alt_distance});
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @fn DeltaStepping::apply
+ * @brief Carries out the requests of one thread, putting the nodes whose distance went down into its buckets
+ */
+template <class Graph>
+void DeltaStepping<Graph>::apply(unsigned t) {
+  Worker& self = workers[t];
+  for (const Request& request : self.requests) {
+    std::atomic<weight_type>& distance = distances[request.node];
+    weight_type current = distance.load(std::memory_order_relaxed);
+    while (request.distance < current) {
+      if (distance.compare_exchange_weak(current, request.distance, std::memory_order_relaxed)) {
+        self.buckets[bucket_of(request.distance) % num_buckets].push_back(request.node);
+        break;
+      }
+    }
+  }
+  self.requests.clear();
+}
+
+/**
+ * @fn DeltaStepping::next_id
+ * @brief The next stamp of the phases or buckets, clearing the stamps when it wraps around
+ */
+template <class Graph>
+uint32_t DeltaStepping<Graph>::next_id(uint32_t id, std::atomic<uint32_t>* stamps, size_t size) {
+  if (++id != 0) return id;
+  for (size_t v = 0; v < size; ++v) stamps[v].store(0, std::memory_order_relaxed);
+  return 1;
+}
+
+template <class Graph>
+void DeltaStepping<Graph>::Barrier::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  uint64_t arrived = generation;
+  if (++waiting == count) {
+    waiting = 0;
+    generation++;
+    condition.notify_all();
+  } else condition.wait(lock, [&]() { return generation != arrived; });
+}
+
+#endif // _DELTA_STEPPING_CPP_INCLUDED
@@ -0,0 +1,100 @@
+/**
+ * @file distance-matrix.cpp
+ * @brief presents the implementation of many-to-many distance tables by one-to-many searches
+ */
+
+#ifndef _DISTANCE_MATRIX_CPP_INCLUDED
+#define _DISTANCE_MATRIX_CPP_INCLUDED
+
+#include <distance-matrix.hpp>
+#include <parallel.hpp>
+#include <atomic>
+#include <limits>
+#include <cstdint>
+
+/**
+ * @class MatrixSearch
+ * @brief The workspace of one thread: a Dijkstra from one source which stops once all targets are settled, reset
+ * lazily with epoch stamps like PathFinder
+ */
+template <class Graph>
+class MatrixSearch {
+public:
+  typedef typename Graph::weight_type weight_type;
+  typedef typename DefaultQueue<Graph, void>::type queue_type;
+
+  explicit MatrixSearch(size_t size)
+    : distances(size), stamps(size, 0), queue(make_queue<queue_type, weight_type>(distances.data())) {
+    queue.reserve_positions(size);
+  }
+
+  MatrixSearch(const MatrixSearch&) = delete;
+  MatrixSearch& operator=(const MatrixSearch&) = delete;
+
+  /**
+   * @fn MatrixSearch::run
+   * @param is_target Whether each node is one of the targets
+   * @param num_targets The number of distinct targets
+   */
+  void run(const Graph& graph, size_t source, const std::vector<bool>& is_target, size_t num_targets) {
+    queue.clear();
+    if (++epoch == 0) {
+      std::fill(stamps.begin(), stamps.end(), 0);
+      epoch = 1;
+    }
+    distances[source] = 0;
+    stamps[source] = epoch;
+    queue.push(source);
+
+    size_t settled_targets = 0;
+    while (!queue.empty() && settled_targets < num_targets) {
+      size_t v = queue.top();
+      queue.pop();
+      if (is_target[v]) settled_targets++;
+      for (Edge<weight_type> edge : graph[v]) {
+        weight_type alt_distance = distances[v] + edge.weight;
+        if (alt_distance >= distance(edge.to)) continue;
+        distances[edge.to] = alt_distance;
+        stamps[edge.to] = epoch;
+        if (queue.contains(edge.to)) queue.decrease_key(edge.to);
+        else queue.push(edge.to);
+      }
+    }
+  }
+
+  inline weight_type distance(size_t v) const {
+    return stamps[v] == epoch ? distances[v] : std::numeric_limits<weight_type>::max();
+  }
+
+private:
+  std::vector<weight_type> distances;
+  std::vector<uint32_t> stamps;
+  uint32_t epoch = 0;
+  queue_type queue;
+};
+
+template <class Graph>
+std::vector<typename Graph::weight_type> distance_matrix(const Graph& graph, const std::vector<size_t>& sources,
+                                                         const std::vector<size_t>& targets, unsigned nthreads) {
+  typedef typename Graph::weight_type weight_type;
+  std::vector<bool> is_target(graph.size(), false);
+  size_t num_targets = 0;
+  for (size_t target : targets) {
+    if (!is_target[target]) num_targets++;
+    is_target[target] = true;
+  }
+
+  std::vector<weight_type> matrix(sources.size() * targets.size());
+  std::atomic<size_t> next(0);
+  run_threads(nthreads, [&](unsigned) {
+    MatrixSearch<Graph> search(graph.size());
+    for (size_t i = next++; i < sources.size(); i = next++) {
+      search.run(graph, sources[i], is_target, num_targets);
+      weight_type* row = matrix.data() + i * targets.size();
+      for (size_t j = 0; j < targets.size(); ++j) row[j] = search.distance(targets[j]);
+    }
+  });
+  return matrix;
+}
+
+#endif // _DISTANCE_MATRIX_CPP_INCLUDED
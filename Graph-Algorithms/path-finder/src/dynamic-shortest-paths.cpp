@@ -0,0 +1,137 @@
+/**
+ * @file dynamic-shortest-paths.cpp
+ * @brief presents the implementation of the shortest path tree repaired after edge changes
+ */
+
+#ifndef _DYNAMIC_SHORTEST_PATHS_CPP_INCLUDED
+#define _DYNAMIC_SHORTEST_PATHS_CPP_INCLUDED
+
+#include <dynamic-shortest-paths.hpp>
+#include <algorithm>
+
+template <class T, class WT>
+DynamicShortestPaths<T, WT>::DynamicShortestPaths(Graph<T, WT>& graph, size_t source)
+  : graph(graph), root(source), in_edges(graph.size()), affected_stamps(graph.size(), 0),
+    queue(make_queue<queue_type, WT>(nullptr)) {
+  for (size_t v = 0; v < graph.size(); ++v)
+    for (const Edge<WT>& edge : graph[v]) in_edges[edge.to].emplace_back(edge.weight, v);
+
+  PathFinder<Graph<T, WT>> path_finder;
+  path_finder.shortest_path_tree(graph, source, distances, parents);
+
+  // The queue orders the nodes by the distances from now on, which don't move again
+  queue = make_queue<queue_type, WT>(distances.data());
+  queue.reserve_positions(graph.size());
+}
+
+template <class T, class WT>
+bool DynamicShortestPaths<T, WT>::update_edge_weight(size_t from, size_t to, WT weight) {
+  if (!graph.update_edge_weight(from, to, weight)) return false;
+  for (Edge<WT>& edge : in_edges[to])
+    if (edge.to == from) edge.weight = weight;
+  changed.emplace_back(from, to);
+  return true;
+}
+
+template <class T, class WT>
+bool DynamicShortestPaths<T, WT>::remove_edge(size_t from, size_t to) {
+  if (!graph.remove_edge(from, to)) return false;
+  std::vector<Edge<WT>>& edges = in_edges[to];
+  edges.erase(std::remove_if(edges.begin(), edges.end(), [from](const Edge<WT>& edge) { return edge.to == from; }),
+              edges.end());
+  changed.emplace_back(from, to);
+  return true;
+}
+
+template <class T, class WT>
+WT DynamicShortestPaths<T, WT>::lightest_edge(size_t from, size_t to) const {
+  WT lightest = unreachable;
+  for (const Edge<WT>& edge : graph[from])
+    if (edge.to == to) lightest = std::min(lightest, edge.weight);
+  return lightest;
+}
+
+/**
+ * @fn DynamicShortestPaths::mark_affected
+ * @brief Marks the subtrees of the tree edges which no longer give their target's distance
+ */
+template <class T, class WT>
+void DynamicShortestPaths<T, WT>::mark_affected() {
+  if (++epoch == 0) { // wrapped around: old stamps could look current
+    std::fill(affected_stamps.begin(), affected_stamps.end(), 0);
+    epoch = 1;
+  }
+  affected.clear();
+  for (auto [from, to] : changed) {
+    if (parents[to] != from || to == root || is_affected(to)) continue;
+    WT weight = lightest_edge(from, to);
+    if (weight != unreachable && distances[from] + weight == distances[to]) continue; // still as short
+    affected_stamps[to] = epoch;
+    affected.push_back(to);
+  }
+
+  // The list grows as it is walked, so it ends up with the whole subtrees
+  for (size_t i = 0; i < affected.size(); ++i) {
+    size_t v = affected[i];
+    for (const Edge<WT>& edge : graph[v]) {
+      if (parents[edge.to] != v || edge.to == root || is_affected(edge.to)) continue;
+      affected_stamps[edge.to] = epoch;
+      affected.push_back(edge.to);
+    }
+  }
+}
+
+template <class T, class WT>
+inline void DynamicShortestPaths<T, WT>::relax(size_t v, size_t parent, WT distance) {
+  if (distance >= distances[v]) return;
+  distances[v] = distance;
+  parents[v] = parent;
+  if (queue.contains(v)) queue.decrease_key(v);
+  else queue.push(v);
+}
+
+template <class T, class WT>
+size_t DynamicShortestPaths<T, WT>::repair() {
+  if (changed.empty()) return 0;
+  queue.clear(); // the keys start over from below the last one popped
+  mark_affected();
+
+  // The affected nodes start from their best in-edge from outside the subtrees, whose distances are still right
+  for (size_t v : affected) {
+    distances[v] = unreachable;
+    parents[v] = npos;
+  }
+  for (size_t v : affected) {
+    for (const Edge<WT>& edge : in_edges[v])
+      if (!is_affected(edge.to) && distances[edge.to] != unreachable)
+        relax(v, edge.to, distances[edge.to] + edge.weight);
+  }
+
+  // Edges which got lighter may give shorter paths
+  for (auto [from, to] : changed) {
+    WT weight = lightest_edge(from, to);
+    if (weight != unreachable && distances[from] != unreachable) relax(to, from, distances[from] + weight);
+  }
+  changed.clear();
+
+  size_t searched = 0;
+  while (!queue.empty()) {
+    size_t v = queue.top();
+    queue.pop();
+    ++searched;
+    for (const Edge<WT>& edge : graph[v]) relax(edge.to, v, distances[v] + edge.weight);
+  }
+  return searched;
+}
+
+template <class T, class WT>
+Path<size_t> DynamicShortestPaths<T, WT>::path_to(size_t v) const {
+  Path<size_t> path;
+  if (parents[v] == npos) return path; // return empty path - no path found
+  for (; v != root; v = parents[v]) path.nodes.push_back(v);
+  path.nodes.push_back(root);
+  std::reverse(path.nodes.begin(), path.nodes.end());
+  return path;
+}
+
+#endif // _DYNAMIC_SHORTEST_PATHS_CPP_INCLUDED
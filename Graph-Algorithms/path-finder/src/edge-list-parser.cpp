@@ -0,0 +1,172 @@
+/**
+ * @file edge-list-parser.cpp
+ * @brief presents the implementation of the parallel edge list parser
+ */
+
+#ifndef _EDGE_LIST_PARSER_CPP_INCLUDED
+#define _EDGE_LIST_PARSER_CPP_INCLUDED
+
+#include <edge-list-parser.hpp>
+#include <mapped-file.hpp>
+#include <parallel.hpp>
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <vector>
+#include <limits>
+#include <cstring>
+
+/**
+ * @struct EdgeListChunk
+ * @brief The edges one thread parsed, and how many of them each node has
+ */
+template <class WT>
+struct EdgeListChunk {
+  std::vector<uint32_t> from;
+  std::vector<uint32_t> to;
+  std::vector<WT> weights;
+  // Per node, how many edges of the chunk it has, then where they go among the node's edges. 32 bits are enough
+  // for any one node's edges, and halve the memory of the nthreads count arrays.
+  std::vector<uint32_t> counts;
+  std::string error;
+};
+
+static inline bool is_blank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * @fn parse_field
+ * @brief Parses a number after any blanks on the same line
+ * @return Where the number ends, or nullptr if there is none
+ */
+template <class V>
+static inline const char* parse_field(const char* at, const char* end, V& value) {
+  while (at < end && is_blank(*at)) ++at;
+  std::from_chars_result result = std::from_chars(at, end, value);
+  return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+/**
+ * @fn parse_chunk
+ * @brief Parses the edges of whole lines in [at, end) into a chunk, skipping empty lines
+ */
+template <class WT>
+static void parse_chunk(const char* at, const char* end, size_t num_nodes, EdgeListChunk<WT>& chunk) {
+  // Every edge ends a line, except maybe the last one, so the arrays never grow
+  size_t max_edges = std::count(at, end, '\n') + 1;
+  chunk.from.reserve(max_edges);
+  chunk.to.reserve(max_edges);
+  chunk.weights.reserve(max_edges);
+  chunk.counts.assign(num_nodes, 0);
+
+  while (at < end) {
+    while (at < end && (is_blank(*at) || *at == '\n')) ++at;
+    if (at == end) break;
+    uint64_t from, to;
+    WT weight;
+    if (!(at = parse_field(at, end, from)) || !(at = parse_field(at, end, to)) ||
+        !(at = parse_field(at, end, weight))) {
+      chunk.error = "expected an edge \"from to weight\"";
+      return;
+    }
+    while (at < end && is_blank(*at)) ++at;
+    if (at < end && *at != '\n') {
+      chunk.error = "expected one edge per line";
+      return;
+    }
+    if (from >= num_nodes || to >= num_nodes) {
+      chunk.error = "edge to or from a node which doesn't exist";
+      return;
+    }
+    chunk.from.push_back((uint32_t) from);
+    chunk.to.push_back((uint32_t) to);
+    chunk.weights.push_back(weight);
+    if (++chunk.counts[from] == 0) {
+      chunk.error = "node with more than 2^32 - 1 edges";
+      return;
+    }
+  }
+}
+
+template <class T, class WT>
+CsrGraph<T, WT> parse_edge_list(const std::string& path, unsigned nthreads) {
+  typedef typename CsrGraph<T, WT>::node_id node_id;
+  nthreads = std::max(1u, nthreads);
+  MappedFile text(path, false);
+  text.advise(MADV_SEQUENTIAL);
+
+  uint64_t num_nodes, num_edges;
+  const char* at = text.begin();
+  const char* end = text.end();
+  auto skip_space = [&]() { while (at < end && (is_blank(*at) || *at == '\n')) ++at; };
+  skip_space();
+  at = parse_field(at, end, num_nodes);
+  if (at) {
+    skip_space();
+    at = parse_field(at, end, num_edges);
+  }
+  if (!at) throw std::runtime_error("expected the number of nodes and of edges");
+  if (num_nodes > std::numeric_limits<node_id>::max()) throw std::runtime_error("node ids must fit in 32 bits");
+
+  // Each chunk starts at a line, right after the newline at or past its share of the file
+  std::vector<const char*> bounds(nthreads + 1, end);
+  bounds[0] = at;
+  for (unsigned t = 1; t < nthreads; ++t) {
+    const char* from = std::max(bounds[t - 1], at + (end - at) / nthreads * t);
+    const char* newline = (const char*) std::memchr(from, '\n', end - from);
+    bounds[t] = newline ? newline + 1 : end;
+  }
+
+  std::vector<EdgeListChunk<WT>> chunks(nthreads);
+  run_threads(nthreads, [&](unsigned t) { parse_chunk(bounds[t], bounds[t + 1], num_nodes, chunks[t]); });
+  size_t parsed = 0;
+  for (const EdgeListChunk<WT>& chunk : chunks) {
+    if (!chunk.error.empty()) throw std::runtime_error(chunk.error + " in " + path);
+    parsed += chunk.from.size();
+  }
+  if (parsed != num_edges)
+    throw std::runtime_error(path + " has " + std::to_string(parsed) + " edges, not " + std::to_string(num_edges));
+
+  // The edges of a node come from the chunks in order, so a chunk's edges of node v go after those of the chunks
+  // before it: the counts become the positions among the edges of v, one range of nodes per thread
+  std::vector<size_t> offsets(num_nodes + 1, 0);
+  auto node_range = [&](unsigned t) {
+    return std::make_pair(num_nodes * t / nthreads, num_nodes * (t + 1) / nthreads);
+  };
+  std::vector<char> too_many(nthreads, false);
+  run_threads(nthreads, [&](unsigned t) {
+    auto range = node_range(t);
+    for (size_t v = range.first; v < range.second; ++v) {
+      size_t position = 0;
+      for (EdgeListChunk<WT>& chunk : chunks) {
+        uint32_t count = chunk.counts[v];
+        chunk.counts[v] = (uint32_t) position;
+        position += count;
+      }
+      offsets[v + 1] = position;
+      if (position > std::numeric_limits<uint32_t>::max()) too_many[t] = true;
+    }
+  });
+  if (std::count(too_many.begin(), too_many.end(), true))
+    throw std::runtime_error("node with more than 2^32 - 1 edges in " + path);
+  for (size_t v = 0; v < num_nodes; ++v) offsets[v + 1] += offsets[v];
+
+  std::vector<node_id> targets(num_edges);
+  std::vector<WT> weights(num_edges);
+  run_threads(nthreads, [&](unsigned t) {
+    EdgeListChunk<WT>& chunk = chunks[t];
+    for (size_t i = 0; i < chunk.from.size(); ++i) {
+      uint32_t v = chunk.from[i];
+      size_t e = offsets[v] + chunk.counts[v]++;
+      targets[e] = chunk.to[i];
+      weights[e] = chunk.weights[i];
+    }
+    std::vector<uint32_t>().swap(chunk.from);
+    std::vector<uint32_t>().swap(chunk.to);
+    std::vector<WT>().swap(chunk.weights);
+  });
+  return CsrGraph<T, WT>(std::move(offsets), std::move(targets), std::move(weights));
+}
+
+#endif // _EDGE_LIST_PARSER_CPP_INCLUDED
@@ -0,0 +1,174 @@
+/**
+ * @file graph-file.cpp
+ * @brief presents the implementation of the binary graph file
+ */
+
+#ifndef _GRAPH_FILE_CPP_INCLUDED
+#define _GRAPH_FILE_CPP_INCLUDED
+
+#include <graph-file.hpp>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <limits>
+#include <cstring>
+
+static const char graph_file_magic[4] = {'C', 'S', 'R', 'G'};
+static const uint32_t graph_file_version = 1;
+
+/**
+ * @fn MappedGraph::layout
+ * @brief Where each array of the file starts: the offsets, the targets, the weights, the node data and the
+ * coordinates (the last two at the end of the file if they aren't stored)
+ * @return The size of the whole file, in bytes
+ */
+template <class T, class WT>
+size_t MappedGraph<T, WT>::layout(const Header& header, size_t sections[5]) {
+  auto padded = [](size_t bytes) { return (bytes + 7) & ~(size_t) 7; };
+  size_t sizes[5] = {
+    (header.num_nodes + 1) * sizeof(uint64_t), header.num_edges * sizeof(node_id), header.num_edges * sizeof(WT),
+    header.num_nodes * header.data_size,
+    header.flags & has_coordinate_section ? header.num_nodes * sizeof(coordinate_type) : 0
+  };
+  size_t at = padded(sizeof(Header));
+  for (int i = 0; i < 5; ++i) {
+    sections[i] = at;
+    at += padded(sizes[i]);
+  }
+  return at;
+}
+
+template <class T, class WT>
+void MappedGraph<T, WT>::save(const CsrGraph<T, WT>& graph, const std::string& path, bool node_data,
+                              const std::vector<coordinate_type>* coordinates) {
+  static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_copyable<WT>::value,
+                "the graph file stores node data and weights as raw bytes");
+  if (coordinates && coordinates->size() != graph.size())
+    throw std::invalid_argument("there must be a coordinate for each node");
+  if (graph.size() > (uint64_t) std::numeric_limits<node_id>::max() + 1)
+    throw std::invalid_argument("node ids must fit in 32 bits");
+
+  Header header;
+  std::memcpy(header.magic, graph_file_magic, sizeof(header.magic));
+  header.version = graph_file_version;
+  header.weight_size = sizeof(WT);
+  header.data_size = node_data ? sizeof(T) : 0;
+  header.flags = (std::is_floating_point<WT>::value ? floating_weights : 0) |
+                 (coordinates ? has_coordinate_section : 0);
+  header.reserved = 0;
+  header.num_nodes = graph.size();
+  header.num_edges = graph.num_edges();
+  size_t sections[5];
+  size_t bytes = layout(header, sections);
+
+  std::ofstream os(path, std::ios::binary);
+  size_t at = 0;
+  auto write = [&](const void* data, size_t size) {
+    os.write((const char*) data, size);
+    at += size;
+  };
+  auto pad_to = [&](size_t section) {
+    static const char zeros[8] = {};
+    write(zeros, section - at);
+  };
+
+  write(&header, sizeof(header));
+  pad_to(sections[0]);
+  for (size_t v = 0; v <= graph.size(); ++v) {
+    uint64_t offset = graph.edge_begin(v);
+    write(&offset, sizeof(offset));
+  }
+  pad_to(sections[1]);
+  for (size_t e = 0; e < graph.num_edges(); ++e) {
+    node_id target = graph.target(e);
+    write(&target, sizeof(target));
+  }
+  pad_to(sections[2]);
+  for (size_t e = 0; e < graph.num_edges(); ++e) {
+    WT weight = graph.weight(e);
+    write(&weight, sizeof(weight));
+  }
+  pad_to(sections[3]);
+  if (node_data)
+    for (size_t v = 0; v < graph.size(); ++v) write(&graph.data(v), sizeof(T));
+  pad_to(sections[4]);
+  if (coordinates) write(coordinates->data(), coordinates->size() * sizeof(coordinate_type));
+  pad_to(bytes);
+  if (!os) throw std::runtime_error("couldn't write graph to " + path);
+}
+
+template <class T, class WT>
+void MappedGraph<T, WT>::convert(std::istream& is, const std::string& path) {
+  size_t num_nodes, num_edges;
+  if (!(is >> num_nodes >> num_edges)) throw std::runtime_error("expected the number of nodes and of edges");
+  if (num_nodes > (uint64_t) std::numeric_limits<node_id>::max() + 1)
+    throw std::runtime_error("node ids must fit in 32 bits");
+
+  std::vector<typename CsrGraph<T, WT>::edge_list_entry> edges;
+  edges.reserve(num_edges);
+  size_t from, to;
+  WT weight;
+  for (size_t i = 0; i < num_edges; ++i) {
+    if (!(is >> from >> to >> weight)) throw std::runtime_error("expected " + std::to_string(num_edges) + " edges");
+    if (from >= num_nodes || to >= num_nodes) throw std::runtime_error("edge to or from a node which doesn't exist");
+    edges.emplace_back(from, to, weight);
+  }
+  save(CsrGraph<T, WT>(num_nodes, edges), path);
+}
+
+template <class T, class WT>
+void MappedGraph<T, WT>::attach(const char* data, size_t size, bool validate) {
+  Header h;
+  if (size < sizeof(Header)) throw std::runtime_error("truncated graph file");
+  std::memcpy(&h, data, sizeof(h));
+  uint32_t weight_kind = std::is_floating_point<WT>::value ? floating_weights : 0;
+  if (!std::equal(h.magic, h.magic + sizeof(h.magic), graph_file_magic) || h.version != graph_file_version ||
+      h.weight_size != sizeof(WT) || (h.flags & floating_weights) != weight_kind ||
+      (h.data_size != 0 && h.data_size != sizeof(T)))
+    throw std::runtime_error("not a graph file of this version and graph type");
+
+  // Counts too large for the file could wrap the layout around to a size which fits
+  size_t sections[5];
+  if (h.num_nodes >= size / sizeof(uint64_t) || h.num_edges > size / sizeof(node_id) || layout(h, sections) > size)
+    throw std::runtime_error("truncated graph file");
+  offsets = (const uint64_t*) (data + sections[0]);
+  targets = (const node_id*) (data + sections[1]);
+  if (offsets[0] != 0 || offsets[h.num_nodes] != h.num_edges) throw std::runtime_error("corrupt graph file");
+  if (validate) {
+    for (size_t v = 0; v < h.num_nodes; ++v)
+      if (offsets[v] > offsets[v + 1]) throw std::runtime_error("corrupt graph file: offsets out of order");
+    for (size_t e = 0; e < h.num_edges; ++e)
+      if (targets[e] >= h.num_nodes) throw std::runtime_error("corrupt graph file: edge to a node which doesn't exist");
+  }
+
+  header = (const Header*) data;
+  weights = (const WT*) (data + sections[2]);
+  node_data = h.data_size ? (const T*) (data + sections[3]) : nullptr;
+  coordinates = h.flags & has_coordinate_section ? (const coordinate_type*) (data + sections[4]) : nullptr;
+}
+
+template <class T, class WT>
+MappedGraph<T, WT> MappedGraph<T, WT>::map(const std::string& path, bool validate) {
+  MappedGraph<T, WT> graph;
+  graph.file = MappedFile(path);
+  graph.attach(graph.file.data(), graph.file.size(), validate); // on error, the file is unmapped again
+  return graph;
+}
+
+template <class T, class WT>
+MappedGraph<T, WT>& MappedGraph<T, WT>::operator=(MappedGraph&& other) noexcept {
+  if (this == &other) return *this;
+  file = std::move(other.file);
+  header = other.header;
+  offsets = other.offsets;
+  targets = other.targets;
+  weights = other.weights;
+  node_data = other.node_data;
+  coordinates = other.coordinates;
+
+  other.header = nullptr;
+  return *this;
+}
+
+#endif // _GRAPH_FILE_CPP_INCLUDED
@@ -0,0 +1,799 @@
+/**
+ * @file graph-test.cpp
+ * @brief Checks that path finding gives the same answers on the different graph representations,
+ * and times it on each of them
+ */
+
+#include "graph.hpp"
+#include "csr-graph.hpp"
+#include "path-finder.hpp"
+#include "bidirectional-path-finder.hpp"
+#include "contraction-hierarchy.hpp"
+#include "landmarks.hpp"
+#include "hub-labels.hpp"
+#include "delta-stepping.hpp"
+#include "distance-matrix.hpp"
+#include "graph-file.hpp"
+#include "edge-list-parser.hpp"
+#include "dynamic-shortest-paths.hpp"
+
+#include <iostream>
+#include <vector>
+#include <random>
+#include <limits>
+#include <cassert>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+#define NODES 200000
+#define EDGES_PER_NODE 8
+#define QUERIES 20
+#define GRID_WIDTH 500
+#define CH_GRID_WIDTH 60
+#define CH_QUERIES 1000
+#define HL_GRID_WIDTH 20
+#define LANDMARKS 8
+#define DELTA_STEPPING_SOURCES 3
+#define MATRIX_SIZE 50
+#define FACILITIES 30
+#define DYNAMIC_BATCHES 5
+#define DYNAMIC_CHANGES 40
+
+typedef Graph<int, int> graph;
+typedef CsrGraph<int, int> csr_graph;
+
+// Wall time, for the tests which run on several threads: clock() adds up the time of all of them
+static double seconds_since(chrono::steady_clock::time_point begin) {
+  return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * @fn path_cost
+ * @return The total weight of a path, taking the lightest edge between consecutive nodes,
+ * or -1 for an empty path
+ */
+template <class G>
+static long path_cost(const G& g, const Path<size_t>& path) {
+  if (path.nodes.empty()) return -1;
+  long cost = 0;
+  for (size_t i = 0; i + 1 < path.nodes.size(); ++i) {
+    int best = numeric_limits<int>::max();
+    for (Edge<int> edge : g[path.nodes[i]])
+      if (edge.to == path.nodes[i + 1] && edge.weight < best) best = edge.weight;
+    assert(best != numeric_limits<int>::max());
+    cost += best;
+  }
+  return cost;
+}
+
+static void random_edges(vector<csr_graph::edge_list_entry>& edges, mt19937& rng) {
+  for (size_t v = 0; v < NODES; ++v)
+    for (int i = 0; i < EDGES_PER_NODE; ++i)
+      edges.emplace_back(v, rng() % NODES, 1 + (int) (rng() % 100));
+  shuffle(edges.begin(), edges.end(), rng);
+}
+
+/**
+ * @fn test_csr_layout
+ * @brief Checks that a CsrGraph built from a Graph and one built from the edge list have the same edges
+ */
+static void test_csr_layout(graph& g, const csr_graph& from_graph, const csr_graph& from_list) {
+  assert(from_graph.size() == g.size() && from_list.size() == g.size());
+  assert(from_graph.num_edges() == from_list.num_edges());
+  for (size_t v = 0; v < g.size(); ++v) {
+    auto a = from_graph[v];
+    auto b = from_list[v];
+    assert(a.num_edges() == g[v].num_edges() && b.num_edges() == a.num_edges());
+    size_t i = 0;
+    for (Edge<int> edge : g[v]) { // counting sort keeps the order of edges from the same node
+      assert(a[i].to == edge.to && a[i].weight == edge.weight);
+      assert(b[i].to == edge.to && b[i].weight == edge.weight);
+      ++i;
+    }
+  }
+  cout << "CSR layout:\tpassed" << endl;
+}
+
+/**
+ * @fn grid_edges
+ * @brief A width x width grid with edges between neighbors in both directions, of weight 10 to 19
+ */
+static void grid_edges(vector<csr_graph::edge_list_entry>& edges, size_t width, mt19937& rng) {
+  for (size_t y = 0; y < width; ++y) {
+    for (size_t x = 0; x < width; ++x) {
+      size_t v = y * width + x;
+      if (x + 1 < width) {
+        edges.emplace_back(v, v + 1, 10 + (int) (rng() % 10));
+        edges.emplace_back(v + 1, v, 10 + (int) (rng() % 10));
+      }
+      if (y + 1 < width) {
+        edges.emplace_back(v, v + width, 10 + (int) (rng() % 10));
+        edges.emplace_back(v + width, v, 10 + (int) (rng() % 10));
+      }
+    }
+  }
+}
+
+/**
+ * @class GridDistance
+ * @brief Consistent lower bound on the distance between two nodes of the grid, since every edge weighs at least 10
+ */
+struct GridDistance {
+  double operator()(size_t from, size_t to) const {
+    long dx = (long) (from % GRID_WIDTH) - (long) (to % GRID_WIDTH);
+    long dy = (long) (from / GRID_WIDTH) - (long) (to / GRID_WIDTH);
+    return 10.0 * (labs(dx) + labs(dy));
+  }
+};
+
+/**
+ * @class IntegerGridDistance
+ * @brief An integer heuristic for the grid, whose differences are odd, so that halving them in integers would
+ * lose something
+ */
+struct IntegerGridDistance {
+  long operator()(size_t from, size_t to) const {
+    long dx = (long) (from % GRID_WIDTH) - (long) (to % GRID_WIDTH);
+    long dy = (long) (from / GRID_WIDTH) - (long) (to / GRID_WIDTH);
+    return 9 * (labs(dx) + labs(dy));
+  }
+};
+
+/**
+ * @fn time_queries
+ * @brief Runs the queries with one path finder, which is reused from one query to the next
+ * @return The cost of the path found for each query
+ */
+template <class G, class Finder=PathFinder<G>>
+static vector<long> time_queries(const string& name, const G& g, const vector<pair<size_t, size_t>>& queries,
+                                 Finder&& path_finder = Finder()) {
+  vector<long> costs;
+  clock_t begin = clock();
+  for (auto query : queries) {
+    Path<size_t> path = path_finder.find_path(g, query.first, query.second);
+    assert(path.nodes.empty() || (path.nodes.front() == query.first && path.nodes.back() == query.second));
+    costs.push_back(path_cost(g, path));
+  }
+  clock_t end = clock();
+  double elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
+  cout << name << ":\t" << elapsed_secs << " [seconds] elapsed" << endl;
+  return costs;
+}
+
+/**
+ * @fn check_queries
+ * @brief Runs the queries with time_queries, and checks that the paths cost as much as expected. The queries run
+ * outside the assert, so they are timed even when asserts are compiled out.
+ */
+template <class G, class Finder=PathFinder<G>>
+static void check_queries(const string& name, const G& g, const vector<pair<size_t, size_t>>& queries,
+                          const vector<long>& costs, Finder&& path_finder = Finder()) {
+  vector<long> found = time_queries(name, g, queries, std::forward<Finder>(path_finder));
+  assert(found == costs);
+  (void) found;
+  (void) costs;
+}
+
+/**
+ * @struct WithReverse
+ * @brief Lets time_queries run a bidirectional path finder on a reverse graph built once for all the queries
+ */
+template <class Finder>
+struct WithReverse {
+  Finder& finder;
+  const typename Finder::reverse_graph_type& reverse;
+
+  template <class G>
+  Path<size_t> find_path(const G& g, size_t source, size_t sink) { return finder.find_path(g, reverse, source, sink); }
+};
+
+/**
+ * @fn test_bidirectional_after_change
+ * @brief Checks that a bidirectional query after an edge changed sees the change
+ */
+static void test_bidirectional_after_change(graph g, size_t source, size_t sink) {
+  BidirectionalPathFinder<graph> bidirectional;
+  Path<size_t> before = bidirectional.find_path(g, source, sink);
+  assert(before.nodes.size() > 1);
+  bool updated = g.update_edge_weight(before.nodes[0], before.nodes[1], 1000000);
+  assert(updated);
+  PathFinder<graph> path_finder;
+  long after = path_cost(g, bidirectional.find_path(g, source, sink));
+  assert(after == path_cost(g, path_finder.find_path(g, source, sink)));
+  (void) updated;
+  (void) after;
+  cout << "Bidirectional after a change:\tpassed" << endl;
+}
+
+/**
+ * @fn test_graph_file
+ * @brief Converts the edge list from text to a graph file, maps it and checks that it has the same edges and
+ * paths, then stores node data and coordinates as well
+ */
+static void test_graph_file(const vector<csr_graph::edge_list_entry>& edges, const csr_graph& g,
+                            const vector<pair<size_t, size_t>>& queries, const vector<long>& costs) {
+  typedef MappedGraph<int, int> mapped_graph;
+  const char* path = "graph-file-test.bin";
+  stringstream text;
+  text << g.size() << " " << edges.size() << "\n";
+  for (auto& edge : edges) text << get<0>(edge) << " " << get<1>(edge) << " " << get<2>(edge) << "\n";
+
+  clock_t begin = clock();
+  mapped_graph::convert(text, path);
+  clock_t end = clock();
+  cout << "Graph file conversion:\t" << double(end - begin) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+  begin = clock();
+  mapped_graph mapped = mapped_graph::map(path);
+  end = clock();
+  cout << "Graph file mapping:\t" << double(end - begin) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+  remove(path); // the mapping stays valid
+
+  assert(mapped.size() == g.size() && mapped.num_edges() == g.num_edges());
+  assert(!mapped.has_data() && !mapped.has_coordinates());
+  for (size_t v = 0; v < g.size(); ++v) {
+    auto a = g[v];
+    auto b = mapped[v];
+    assert(a.num_edges() == b.num_edges());
+    for (size_t i = 0; i < a.num_edges(); ++i) assert(a[i].to == b[i].to && a[i].weight == b[i].weight);
+  }
+  check_queries("Mapped graph", mapped, queries, costs);
+
+  csr_graph with_data(g.size(), edges);
+  vector<mapped_graph::coordinate_type> coordinates(g.size());
+  for (size_t v = 0; v < g.size(); ++v) {
+    with_data.data(v) = (int) (v * 7);
+    coordinates[v].components[0] = (double) v;
+    coordinates[v].components[1] = -(double) v / 2;
+  }
+  mapped_graph::save(with_data, path, true, &coordinates);
+  mapped = mapped_graph::map(path);
+  remove(path);
+  assert(mapped.has_data() && mapped.has_coordinates());
+  for (size_t v = 0; v < g.size(); ++v) {
+    assert(mapped.data(v) == (int) (v * 7));
+    assert(mapped.coordinate(v).components[0] == (double) v && mapped.coordinate(v).components[1] == -(double) v / 2);
+  }
+
+  // A file of another weight type is refused
+  mapped_graph::save(with_data, path);
+  bool refused = false;
+  try {
+    MappedGraph<int, double>::map(path);
+  } catch (const runtime_error&) {
+    refused = true;
+  }
+  assert(refused);
+
+  // So are offsets out of order and edges to nodes which don't exist, unless validation is skipped. The offsets
+  // follow the 40 byte header, and the targets follow the offsets.
+  auto corrupted = [&](size_t at, auto value) {
+    fstream file(path, ios::in | ios::out | ios::binary);
+    file.seekp(at);
+    file.write((const char*) &value, sizeof(value));
+    file.close();
+    bool refused = false;
+    try {
+      mapped_graph::map(path);
+    } catch (const runtime_error&) {
+      refused = true;
+    }
+    bool mapped_unchecked = mapped_graph::map(path, false).size() == g.size();
+    mapped_graph::save(with_data, path);
+    return refused && mapped_unchecked;
+  };
+  bool bad_offsets = corrupted(40 + sizeof(uint64_t), (uint64_t) g.num_edges());
+  bool bad_target = corrupted(40 + (g.size() + 1) * sizeof(uint64_t), (uint32_t) g.size());
+  assert(bad_offsets && bad_target);
+  remove(path);
+  cout << "Graph file:\tpassed" << endl;
+}
+
+/**
+ * @fn test_edge_list_parser
+ * @brief Checks that parsing the text format on one or several threads gives the same graph as the edge list,
+ * and times it against reading it through an istream
+ */
+static void test_edge_list_parser(const vector<csr_graph::edge_list_entry>& edges, const csr_graph& g) {
+  const char* path = "edge-list-test.txt";
+  {
+    ofstream os(path);
+    os << g.size() << " " << edges.size() << "\n";
+    for (auto& edge : edges) os << get<0>(edge) << " " << get<1>(edge) << " " << get<2>(edge) << "\n";
+  }
+
+  clock_t begin = clock();
+  graph read;
+  ifstream is(path);
+  is >> read;
+  clock_t end = clock();
+  cout << "Reading with operator>>:\t" << double(end - begin) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+
+  for (unsigned nthreads : {1, 4}) {
+    auto parse_begin = chrono::steady_clock::now();
+    csr_graph parsed = parse_edge_list<int, int>(path, nthreads);
+    double elapsed = seconds_since(parse_begin);
+    cout << "Parsing, " << nthreads << " threads:\t" << elapsed << " [seconds] elapsed" << endl;
+    assert(parsed.size() == g.size() && parsed.num_edges() == g.num_edges());
+    for (size_t v = 0; v <= g.size(); ++v) assert(parsed.edge_begin(v) == g.edge_begin(v));
+    for (size_t e = 0; e < g.num_edges(); ++e) assert(parsed.target(e) == g.target(e) && parsed.weight(e) == g.weight(e));
+  }
+
+  // Floating point weights, blank lines and carriage returns, and more threads than lines
+  {
+    ofstream os(path);
+    os << "3 3\n0 1 0.5\n\n1 2 1e-1\r\n  2\t0 3";
+  }
+  for (unsigned nthreads : {1, 8}) {
+    CsrGraph<int, double> parsed = parse_edge_list<int, double>(path, nthreads);
+    assert(parsed.size() == 3 && parsed.num_edges() == 3);
+    assert(parsed[0][0].to == 1 && parsed[0][0].weight == 0.5);
+    assert(parsed[1][0].to == 2 && parsed[1][0].weight == 0.1);
+    assert(parsed[2][0].to == 0 && parsed[2][0].weight == 3);
+  }
+
+  for (const char* text : {"3 2\n0 1 5\n", "3 1\n0 3 5\n", "3 1\n0 1 5 7\n", "3 1\n0 1 x\n", ""}) {
+    {
+      ofstream os(path);
+      os << text;
+    }
+    bool refused = false;
+    try {
+      parse_edge_list<int, int>(path, 2);
+    } catch (const runtime_error&) {
+      refused = true;
+    }
+    assert(refused);
+  }
+  remove(path);
+  cout << "Edge list parser:\tpassed" << endl;
+}
+
+/**
+ * @fn test_dynamic_shortest_paths
+ * @brief Changes and removes batches of edges, on the shortest path tree and off it, and checks the repaired
+ * tree against one computed from scratch
+ */
+static void test_dynamic_shortest_paths(graph g, size_t source, mt19937& rng) {
+  assert(!g.update_edge_weight(source, source, 1) && !g.remove_edge(source, source)); // random_edges has no loops
+  DynamicShortestPaths<int, int> dynamic(g, source);
+  PathFinder<graph> path_finder;
+  vector<int> distances;
+  vector<size_t> prevs;
+  clock_t repair_time = 0, rebuild_time = 0;
+  size_t searched = 0;
+  for (int batch = 0; batch < DYNAMIC_BATCHES; ++batch) {
+    for (int i = 0; i < DYNAMIC_CHANGES; ++i) {
+      size_t from, to;
+      if (i % 2 == 0) { // an edge of the tree
+        do to = rng() % g.size(); while (to == source || dynamic.parent(to) == DynamicShortestPaths<int, int>::npos);
+        from = dynamic.parent(to);
+      } else {
+        do from = rng() % g.size(); while (g[from].num_edges() == 0);
+        to = g[from][rng() % g[from].num_edges()].to;
+      }
+      int weight = g[from][0].weight;
+      for (Edge<int> edge : g[from]) if (edge.to == to) weight = edge.weight;
+      bool changed;
+      switch (rng() % 3) {
+        case 0: changed = dynamic.update_edge_weight(from, to, weight + 1 + (int) (rng() % 100)); break;
+        case 1: changed = dynamic.update_edge_weight(from, to, (int) (rng() % (weight + 1))); break;
+        default: changed = dynamic.remove_edge(from, to); break;
+      }
+      assert(changed);
+      (void) changed;
+    }
+
+    clock_t begin = clock();
+    searched += dynamic.repair();
+    clock_t end = clock();
+    repair_time += end - begin;
+    path_finder.shortest_path_tree(g, source, distances, prevs);
+    rebuild_time += clock() - end;
+
+    for (size_t v = 0; v < g.size(); ++v) {
+      assert(dynamic.distance(v) == distances[v]);
+      if (v == source || distances[v] == numeric_limits<int>::max()) continue;
+      Path<size_t> path = dynamic.path_to(v);
+      assert(path.nodes.front() == source && path.nodes.back() == v && path_cost(g, path) == distances[v]);
+    }
+  }
+  cout << "Dynamic repairs:\t" << double(repair_time) / CLOCKS_PER_SEC << " [seconds] elapsed, "
+       << searched / DYNAMIC_BATCHES << " nodes searched per batch" << endl;
+  cout << "Rebuilt trees:\t" << double(rebuild_time) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+}
+
+/**
+ * @fn test_shortest_path_tree
+ * @brief Checks one-to-all trees and isochrones against the costs of point to point queries
+ */
+static void test_shortest_path_tree(const csr_graph& g, const vector<pair<size_t, size_t>>& queries,
+                                    const vector<long>& costs) {
+  PathFinder<csr_graph> path_finder;
+  vector<int> distances;
+  vector<size_t> prevs;
+  clock_t begin = clock();
+  for (size_t i = 0; i < queries.size(); ++i) {
+    size_t source = queries[i].first;
+    path_finder.shortest_path_tree(g, source, distances, prevs);
+    assert(distances[queries[i].second] == costs[i]);
+    assert(prevs[source] == source && distances[source] == 0);
+    for (size_t v = 0; v < g.size(); ++v) {
+      if (v == source) continue;
+      int best = numeric_limits<int>::max();
+      for (Edge<int> edge : g[prevs[v]])
+        if (edge.to == v) best = min(best, distances[prevs[v]] + edge.weight);
+      assert(best == distances[v]);
+    }
+  }
+  clock_t end = clock();
+  cout << "Shortest path trees:\t" << double(end - begin) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+
+  clock_t elapsed = 0;
+  for (size_t i = 0; i < queries.size(); ++i) {
+    path_finder.shortest_path_tree(g, queries[i].first, distances, prevs);
+    int budget = (int) costs[i];
+    begin = clock();
+    const vector<size_t>& reached = path_finder.within(g, queries[i].first, budget);
+    elapsed += clock() - begin;
+    const size_t* memory = reached.data();
+    assert((size_t) count_if(distances.begin(), distances.end(), [&](int d) { return d <= budget; }) == reached.size());
+    assert(find(reached.begin(), reached.end(), queries[i].second) != reached.end());
+    for (size_t v : reached) assert(path_finder.distance_to(v) == distances[v]);
+    assert(path_finder.within(g, queries[i].first, budget).data() == memory); // no new allocation
+  }
+  cout << "Isochrones:\t" << double(elapsed) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+}
+
+/**
+ * @fn test_nearest
+ * @brief Checks the nearest of several sources and targets, with Dijkstra and A*, against the distances of a
+ * shortest path tree
+ */
+static void test_nearest(const csr_graph& g, const vector<pair<size_t, size_t>>& queries, mt19937& rng) {
+  vector<size_t> facilities;
+  for (int i = 0; i < FACILITIES; ++i) facilities.push_back(rng() % g.size());
+  facilities.push_back(facilities.front()); // listed twice
+
+  csr_graph reverse = csr_graph::reverse_of(g);
+  PathFinder<csr_graph> path_finder;
+  PathFinder<csr_graph, GridDistance> astar(GridDistance{});
+  vector<int> distances;
+  vector<size_t> prevs;
+  clock_t elapsed = 0;
+  for (auto query : queries) {
+    // Distances from every node to the sink, and from the source to every node
+    path_finder.shortest_path_tree(reverse, query.second, distances, prevs);
+    int nearest_source = numeric_limits<int>::max();
+    for (size_t facility : facilities) nearest_source = min(nearest_source, distances[facility]);
+    path_finder.shortest_path_tree(g, query.first, distances, prevs);
+    int nearest_target = numeric_limits<int>::max();
+    for (size_t facility : facilities) nearest_target = min(nearest_target, distances[facility]);
+
+    clock_t begin = clock();
+    auto source = path_finder.find_nearest_source(g, facilities, query.second);
+    auto target = path_finder.find_nearest_target(g, query.first, facilities);
+    elapsed += clock() - begin;
+    auto astar_source = astar.find_nearest_source(g, facilities, query.second);
+
+    auto check_source = [&](size_t index, size_t node, const Path<size_t>& path) {
+      assert(facilities[index] == node);
+      assert(path.nodes.front() == node && path.nodes.back() == query.second);
+      assert(path_cost(g, path) == nearest_source);
+    };
+    check_source(source.index, source.node, source.path);
+    check_source(astar_source.index, astar_source.node, astar_source.path);
+    assert(facilities[target.index] == target.node);
+    assert(target.path.nodes.front() == query.first && target.path.nodes.back() == target.node);
+    assert(path_cost(g, target.path) == nearest_target);
+  }
+  cout << "Nearest facility:\t" << double(elapsed) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+
+  // Nothing to reach
+  assert(path_finder.find_nearest_target(g, 0, {}).index == PathFinder<csr_graph>::npos);
+  assert(path_finder.find_nearest_source(g, {}, 0).path.nodes.empty());
+}
+
+/**
+ * @fn test_delta_stepping
+ * @brief Checks that delta-stepping gives the same distances as Dijkstra, with light edges only, heavy edges only
+ * and a mix, on one and on several threads
+ */
+static void test_delta_stepping(const csr_graph& g, const vector<pair<size_t, size_t>>& queries, const vector<long>& costs) {
+  for (size_t i = 0; i < DELTA_STEPPING_SOURCES; ++i) {
+    vector<int> first;
+    for (int delta : {1, 10, 100}) {
+      for (unsigned nthreads : {1, 4}) {
+        DeltaStepping<csr_graph> delta_stepping(g, delta, nthreads);
+        const vector<int>& distances = delta_stepping.run(queries[i].first);
+        long distance = distances[queries[i].second];
+        assert(distance == (costs[i] < 0 ? DeltaStepping<csr_graph>::unreachable : costs[i]));
+        if (first.empty()) first = distances;
+        else assert(distances == first);
+      }
+    }
+  }
+  cout << "Delta-stepping:\tpassed" << endl;
+}
+
+/**
+ * @fn test_landmarks
+ * @brief Checks the landmark distances against Dijkstra's, and runs the queries with ALT
+ */
+static void test_landmarks(const csr_graph& g, const vector<pair<size_t, size_t>>& queries, const vector<long>& costs) {
+  typedef Landmarks<int> landmarks_type;
+  typedef LandmarkHeuristic<int> alt;
+  csr_graph reverse = csr_graph::reverse_of(g);
+  for (landmarks_type::Selection selection : {landmarks_type::Selection::avoid, landmarks_type::Selection::farthest}) {
+    bool avoid = selection == landmarks_type::Selection::avoid;
+    clock_t begin = clock();
+    landmarks_type landmarks = landmarks_type::build(g, LANDMARKS, selection);
+    clock_t end = clock();
+    cout << (avoid ? "Avoid" : "Farthest") << " landmarks:\t" << double(end - begin) / CLOCKS_PER_SEC
+         << " [seconds] elapsed" << endl;
+
+    PathFinder<csr_graph> path_finder;
+    for (size_t i = 0; i < landmarks.size(); ++i) {
+      size_t landmark = landmarks.landmark(i);
+      size_t v = queries[i].first;
+      assert(path_cost(g, path_finder.find_path(g, landmark, v)) == landmarks.distance_from(i, v));
+      assert(path_cost(g, path_finder.find_path(g, v, landmark)) == landmarks.distance_to(i, v));
+    }
+    for (size_t i = 0; i < queries.size(); ++i)
+      assert(landmarks.lower_bound(queries[i].first, queries[i].second) <= costs[i]);
+
+    check_queries(avoid ? "Grid, ALT (avoid)" : "Grid, ALT (farthest)", g, queries, costs,
+                  PathFinder<csr_graph, alt>(alt(landmarks)));
+    BidirectionalPathFinder<csr_graph, alt> bidirectional{alt(landmarks)};
+    check_queries(avoid ? "Grid, bidirectional ALT (avoid)" : "Grid, bidirectional ALT (farthest)", g, queries, costs,
+                  WithReverse<decltype(bidirectional)>{bidirectional, reverse});
+  }
+}
+
+/**
+ * @fn test_contraction_hierarchy
+ * @brief Checks distances and unpacked paths of a contraction hierarchy against Dijkstra's, before and
+ * after saving and loading it
+ */
+static ContractionHierarchy<int> test_contraction_hierarchy(const csr_graph& g, const vector<pair<size_t, size_t>>& queries,
+                                                            const vector<long>& costs) {
+  clock_t begin = clock();
+  ContractionHierarchy<int> ch = ContractionHierarchy<int>::build(g);
+  clock_t end = clock();
+  cout << "CH preprocessing:\t" << double(end - begin) / CLOCKS_PER_SEC << " [seconds] elapsed, "
+       << ch.num_shortcuts() << " shortcuts" << endl;
+
+  stringstream saved;
+  ch.save(saved);
+  ContractionHierarchy<int> loaded = ContractionHierarchy<int>::load(saved);
+
+  // Truncated and corrupt streams are refused. The magic, version, weight size and number of shortcuts take 20
+  // bytes, then each vector is its length and its elements: the rank, then the offsets and targets going up.
+  auto refused = [](const string& bytes) {
+    stringstream is(bytes);
+    try {
+      ContractionHierarchy<int>::load(is);
+    } catch (const runtime_error&) {
+      return true;
+    }
+    return false;
+  };
+  auto patched = [&](size_t at, uint64_t value, size_t size) {
+    string bytes = saved.str();
+    bytes.replace(at, size, (const char*) &value, size);
+    return bytes;
+  };
+  size_t first_target = 20 + 8 + ch.size() * sizeof(uint32_t) + 8 + (ch.size() + 1) * sizeof(uint64_t) + 8;
+  bool truncated = refused(saved.str().substr(0, saved.str().size() / 2));
+  bool huge_length = refused(patched(20, (uint64_t) 1 << 60, sizeof(uint64_t)));
+  bool bad_target = refused(patched(first_target, ch.size(), sizeof(uint32_t)));
+  assert(truncated && huge_length && bad_target);
+
+  for (ContractionHierarchy<int>* hierarchy : {&ch, &loaded}) {
+    vector<long> distances;
+    begin = clock();
+    for (size_t i = 0; i < queries.size(); ++i) {
+      Path<size_t> path = hierarchy->find_path(queries[i].first, queries[i].second);
+      assert(path_cost(g, path) == costs[i]);
+      assert(path.nodes.front() == queries[i].first && path.nodes.back() == queries[i].second);
+      distances.push_back(hierarchy->distance(queries[i].first, queries[i].second));
+    }
+    end = clock();
+    assert(distances == costs);
+    cout << "CH queries:\t" << double(end - begin) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+  }
+  return ch;
+}
+
+/**
+ * @fn test_distance_matrix
+ * @brief Checks many-to-many tables, by one-to-many searches and by the contraction hierarchy, against point to
+ * point queries
+ */
+static void test_distance_matrix(const csr_graph& g, const ContractionHierarchy<int>& ch, mt19937& rng) {
+  vector<size_t> sources, targets;
+  for (int i = 0; i < MATRIX_SIZE; ++i) {
+    sources.push_back(rng() % g.size());
+    targets.push_back(rng() % g.size());
+  }
+  targets.push_back(targets.front()); // repeated targets get a column each
+
+  vector<int> expected;
+  PathFinder<csr_graph> path_finder;
+  clock_t begin = clock();
+  for (size_t source : sources)
+    for (size_t target : targets) expected.push_back((int) path_cost(g, path_finder.find_path(g, source, target)));
+  clock_t end = clock();
+  cout << "Point to point table:\t" << double(end - begin) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+
+  for (unsigned nthreads : {1, 4}) {
+    auto matrix_begin = chrono::steady_clock::now();
+    vector<int> matrix = distance_matrix(g, sources, targets, nthreads);
+    double elapsed = seconds_since(matrix_begin);
+    assert(matrix == expected);
+    cout << "Distance matrix, " << nthreads << " threads:\t" << elapsed << " [seconds] elapsed" << endl;
+
+    matrix_begin = chrono::steady_clock::now();
+    matrix = ch.distance_matrix(sources, targets, nthreads);
+    elapsed = seconds_since(matrix_begin);
+    assert(matrix == expected);
+    cout << "CH distance matrix, " << nthreads << " threads:\t" << elapsed << " [seconds] elapsed" << endl;
+  }
+}
+
+/**
+ * @fn check_hub_labels
+ * @brief Checks hub label distances against Dijkstra's, before and after mapping them from a file
+ */
+static void check_hub_labels(const string& name, const HubLabels<int>& labels, const vector<pair<size_t, size_t>>& queries,
+                             const vector<long>& costs) {
+  const char* path = "hub-labels-test.bin";
+  labels.save(path);
+  const HubLabels<int> mapped = HubLabels<int>::map(path);
+  remove(path); // the mapping stays valid
+
+  // Out-label offsets out of order are refused, unless validation is skipped, and so are counts which don't fit
+  // the file. The header is 40 bytes, with the number of nodes at byte 16, and the out-label offsets follow it. A
+  // copy is corrupted, since the mapping above shares the pages of the file.
+  const char* corrupt_path = "hub-labels-corrupt.bin";
+  labels.save(corrupt_path);
+  auto corrupted = [&](size_t at, uint64_t value, bool validate) {
+    fstream file(corrupt_path, ios::in | ios::out | ios::binary);
+    file.seekp(at);
+    file.write((const char*) &value, sizeof(value));
+    file.close();
+    bool refused = false;
+    try {
+      HubLabels<int>::map(corrupt_path, validate);
+    } catch (const runtime_error&) {
+      refused = true;
+    }
+    labels.save(corrupt_path);
+    return refused;
+  };
+  uint64_t second_offset;
+  {
+    ifstream file(corrupt_path, ios::binary);
+    file.seekg(40 + 2 * sizeof(uint64_t));
+    file.read((char*) &second_offset, sizeof(second_offset));
+  }
+  bool out_of_order = corrupted(40 + sizeof(uint64_t), second_offset + 1, true);
+  bool unchecked = corrupted(40 + sizeof(uint64_t), second_offset + 1, false);
+  bool too_many_nodes = corrupted(16, (uint64_t) 1 << 61, false);
+  assert(out_of_order && !unchecked && too_many_nodes);
+  remove(corrupt_path);
+
+  for (const HubLabels<int>* hub_labels : {&labels, &mapped}) {
+    vector<long> distances;
+    clock_t begin = clock();
+    for (size_t i = 0; i < queries.size(); ++i)
+      distances.push_back(hub_labels->distance(queries[i].first, queries[i].second));
+    clock_t end = clock();
+    assert(distances == costs);
+    cout << name << " queries:\t" << double(end - begin) / CLOCKS_PER_SEC << " [seconds] elapsed, "
+         << double(labels.num_entries()) / (2 * labels.size()) << " hubs per label" << endl;
+  }
+}
+
+/**
+ * @fn test_hub_labels
+ * @brief Checks hub labels in the order of a contraction hierarchy, and by degree. On a grid, where nearly all
+ * nodes have the same degree, the latter makes huge labels, so it only gets a tiny one.
+ */
+static void test_hub_labels(const csr_graph& g, const vector<pair<size_t, size_t>>& queries, const vector<long>& costs,
+                            const ContractionHierarchy<int>& ch, mt19937& rng) {
+  clock_t begin = clock();
+  HubLabels<int> labels = HubLabels<int>::build(g, ch);
+  clock_t end = clock();
+  cout << "Hub labels (CH rank):\t" << double(end - begin) / CLOCKS_PER_SEC << " [seconds] elapsed" << endl;
+  check_hub_labels("Hub labels (CH rank)", labels, queries, costs);
+
+  vector<csr_graph::edge_list_entry> edges;
+  grid_edges(edges, HL_GRID_WIDTH, rng);
+  csr_graph tiny_grid(HL_GRID_WIDTH * HL_GRID_WIDTH, edges);
+  vector<pair<size_t, size_t>> tiny_queries;
+  for (int i = 0; i < CH_QUERIES; ++i) tiny_queries.emplace_back(rng() % tiny_grid.size(), rng() % tiny_grid.size());
+  vector<long> tiny_costs = time_queries("Tiny grid", tiny_grid, tiny_queries);
+  check_hub_labels("Hub labels (degree)", HubLabels<int>::build(tiny_grid), tiny_queries, tiny_costs);
+}
+
+int main() {
+  mt19937 rng(0);
+  vector<csr_graph::edge_list_entry> edges;
+  random_edges(edges, rng);
+
+  graph g(NODES);
+  for (auto& edge : edges) g.add_edge(get<0>(edge), get<1>(edge), get<2>(edge));
+  csr_graph from_graph(g);
+  csr_graph from_list(NODES, edges);
+  test_csr_layout(g, from_graph, from_list);
+
+  vector<pair<size_t, size_t>> queries;
+  for (int i = 0; i < QUERIES; ++i) queries.emplace_back(rng() % NODES, rng() % NODES);
+
+  vector<long> costs = time_queries("Graph", g, queries);
+  check_queries("CsrGraph", from_list, queries, costs);
+
+  // A fresh PathFinder per query can't be affected by what earlier queries left behind
+  for (int i = 0; i < QUERIES; ++i) {
+    PathFinder<csr_graph> path_finder;
+    assert(path_cost(from_list, path_finder.find_path(from_list, queries[i].first, queries[i].second)) == costs[i]);
+  }
+  cout << "Reused PathFinder:\tpassed" << endl;
+
+  test_graph_file(edges, from_list, queries, costs);
+  test_edge_list_parser(edges, from_list);
+
+  test_delta_stepping(from_list, queries, costs);
+  test_dynamic_shortest_paths(g, queries[0].first, rng);
+
+  typedef BidirectionalPathFinder<csr_graph> bidirectional;
+  bidirectional bidirectional_finder;
+  csr_graph reverse = csr_graph::reverse_of(from_list);
+  check_queries("Bidirectional", from_list, queries, costs, WithReverse<bidirectional>{bidirectional_finder, reverse});
+  BidirectionalPathFinder<graph> graph_bidirectional_finder;
+  csr_graph graph_reverse = csr_graph::reverse_of(g);
+  check_queries("Bidirectional (Graph)", g, queries, costs,
+                WithReverse<BidirectionalPathFinder<graph>>{graph_bidirectional_finder, graph_reverse});
+  test_bidirectional_after_change(g, queries[0].first, queries[0].second);
+
+  // A* needs a heuristic, which the grid has
+  edges.clear();
+  grid_edges(edges, GRID_WIDTH, rng);
+  csr_graph grid(GRID_WIDTH * GRID_WIDTH, edges);
+  queries.clear();
+  for (int i = 0; i < QUERIES; ++i) queries.emplace_back(rng() % grid.size(), rng() % grid.size());
+  queries.emplace_back(7, 7);
+
+  costs = time_queries("Grid", grid, queries);
+  reverse = csr_graph::reverse_of(grid);
+  check_queries("Grid, bidirectional", grid, queries, costs, WithReverse<bidirectional>{bidirectional_finder, reverse});
+  typedef BidirectionalPathFinder<csr_graph, GridDistance> bidirectional_astar;
+  bidirectional_astar astar_finder(GridDistance{});
+  check_queries("Grid, bidirectional A*", grid, queries, costs,
+                WithReverse<bidirectional_astar>{astar_finder, reverse});
+  typedef BidirectionalPathFinder<csr_graph, IntegerGridDistance> integer_astar;
+  integer_astar integer_astar_finder(IntegerGridDistance{});
+  check_queries("Grid, bidirectional A* (integer heuristic)", grid, queries, costs,
+                WithReverse<integer_astar>{integer_astar_finder, reverse});
+
+  test_shortest_path_tree(grid, queries, costs);
+  test_landmarks(grid, queries, costs);
+  test_nearest(grid, queries, rng);
+
+  // Grids are the hard case for contraction hierarchies and hub labels, so these get a small one
+  edges.clear();
+  grid_edges(edges, CH_GRID_WIDTH, rng);
+  csr_graph small_grid(CH_GRID_WIDTH * CH_GRID_WIDTH, edges);
+  queries.clear();
+  for (int i = 0; i < CH_QUERIES; ++i) queries.emplace_back(rng() % small_grid.size(), rng() % small_grid.size());
+  costs = time_queries("Small grid", small_grid, queries);
+
+  ContractionHierarchy<int> ch = test_contraction_hierarchy(small_grid, queries, costs);
+  test_distance_matrix(small_grid, ch, rng);
+  test_hub_labels(small_grid, queries, costs, ch, rng);
+}
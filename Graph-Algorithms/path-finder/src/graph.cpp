@@ -35,11 +35,36 @@ void Graph<T, WT>::add_edge(size_t from, size_t to, WT weight) {
   nodes[from].add_edge(weight, to);
 }
 
+template <class T, class WT>
+bool Graph<T, WT>::update_edge_weight(size_t from, size_t to, WT weight) {
+  bool found = false;
+  for (Edge<WT>& edge : nodes[from]) {
+    if (edge.to != to) continue;
+    edge.weight = weight;
+    found = true;
+  }
+  return found;
+}
+
+template <class T, class WT>
+bool Graph<T, WT>::remove_edge(size_t from, size_t to) {
+  Node<T, WT>& node = nodes[from];
+  size_t before = node.num_edges();
+  for (size_t i = before; i-- > 0;)
+    if (node[i].to == to) node.remove_edge(i);
+  return node.num_edges() != before;
+}
+
 template <class T, class WT>
 Node<T, WT>& Graph<T, WT>::operator[](int i) {
   return nodes[i];
 }
 
+template <class T, class WT>
+const Node<T, WT>& Graph<T, WT>::operator[](int i) const {
+  return nodes[i];
+}
+
 template <class T, class WT>
 std::istream& operator>>(std::istream& is, Graph<T, WT>& graph) {
   size_t num_nodes, num_edges;
@@ -0,0 +1,342 @@
+/**
+ * @file hub-labels.cpp
+ * @brief presents the implementation of pruned landmark labeling and hub label queries
+ */
+
+#ifndef _HUB_LABELS_CPP_INCLUDED
+#define _HUB_LABELS_CPP_INCLUDED
+
+#include <hub-labels.hpp>
+#include <csr-graph.hpp>
+#include <path-finder.hpp>
+#include <algorithm>
+#include <numeric>
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @class HubLabelBuilder
+ * @brief The labels while they are being built, and the workspace of the pruned searches
+ */
+template <class G>
+class HubLabelBuilder {
+public:
+  typedef typename G::weight_type WT;
+  typedef uint32_t hub_id;
+  typedef CsrGraph<typename G::data_type, WT> reverse_graph_type;
+  typedef typename DefaultQueue<G, void>::type queue_type;
+  static constexpr WT unreached = std::numeric_limits<WT>::max();
+
+  struct Label {
+    std::vector<hub_id> hubs;   // in the order they were added, so sorted
+    std::vector<WT> distances;
+  };
+
+  std::vector<Label> out_labels;
+  std::vector<Label> in_labels;
+
+  explicit HubLabelBuilder(const G& graph)
+    : out_labels(graph.size()), in_labels(graph.size()), graph(graph),
+      reverse(reverse_graph_type::reverse_of(graph)), distances(graph.size(), unreached),
+      hub_distances(graph.size(), unreached), queue(make_queue<queue_type, WT>(distances.data())) {
+    queue.reserve_positions(graph.size());
+  }
+
+  HubLabelBuilder(const HubLabelBuilder&) = delete;
+  HubLabelBuilder& operator=(const HubLabelBuilder&) = delete;
+
+  /**
+   * @fn HubLabelBuilder::add_hub
+   * @brief Adds v as a hub to the in-labels of the nodes it reaches and the out-labels of those reaching it,
+   * wherever the labels don't give the distance already
+   */
+  void add_hub(size_t v, hub_id hub) {
+    search(graph, v, hub, out_labels[v], in_labels);
+    search(reverse, v, hub, in_labels[v], out_labels);
+  }
+
+private:
+  const G& graph;
+  reverse_graph_type reverse;
+
+  std::vector<WT> distances;      // unreached for nodes the current search hasn't touched
+  std::vector<size_t> touched;
+  std::vector<WT> hub_distances;  // by hub, the distance between v and the hubs of its own label
+  queue_type queue;
+
+  /**
+   * @fn HubLabelBuilder::search
+   * @brief A Dijkstra from v which doesn't go on from nodes whose distance from v the labels already cover
+   * @param own The label of v on the other side, the distances between v and the hubs added before it
+   * @param labels The labels the searched nodes get v added to
+   */
+  template <class Graph>
+  void search(const Graph& g, size_t v, hub_id hub, const Label& own, std::vector<Label>& labels) {
+    queue.clear(); // a monotone queue must start over from 0 after the last search's keys
+    for (size_t i = 0; i < own.hubs.size(); ++i) hub_distances[own.hubs[i]] = own.distances[i];
+    distances[v] = 0;
+    touched.push_back(v);
+    queue.push(v);
+
+    while (!queue.empty()) {
+      size_t u = queue.top();
+      queue.pop();
+      WT distance = distances[u];
+      if (covered(labels[u], distance)) continue; // pruned
+      labels[u].hubs.push_back(hub);
+      labels[u].distances.push_back(distance);
+
+      for (Edge<WT> edge : g[u]) {
+        WT alt_distance = distance + edge.weight;
+        if (alt_distance >= distances[edge.to]) continue;
+        if (distances[edge.to] == unreached) touched.push_back(edge.to);
+        distances[edge.to] = alt_distance;
+        if (queue.contains(edge.to)) queue.decrease_key(edge.to);
+        else queue.push(edge.to);
+      }
+    }
+
+    for (size_t u : touched) distances[u] = unreached;
+    touched.clear();
+    for (hub_id h : own.hubs) hub_distances[h] = unreached;
+  }
+
+  bool covered(const Label& label, WT distance) const {
+    for (size_t i = 0; i < label.hubs.size(); ++i) {
+      WT to_hub = hub_distances[label.hubs[i]];
+      if (to_hub != unreached && to_hub + label.distances[i] <= distance) return true;
+    }
+    return false;
+  }
+};
+
+static const char hub_labels_magic[4] = {'H', 'L', 'P', 'F'};
+static const uint32_t hub_labels_version = 1;
+
+static inline size_t pad8(size_t bytes) {
+  return (bytes + 7) & ~(size_t) 7;
+}
+
+/**
+ * @fn hub_labels_layout
+ * @brief Where each array of the labels starts: the offsets of the in- and out-labels, the hubs and distances of
+ * the out-labels, then of the in-labels
+ * @return The size of the whole image, in bytes
+ */
+static size_t hub_labels_layout(size_t header_size, size_t weight_size, uint64_t num_nodes, uint64_t out_entries,
+                                uint64_t in_entries, size_t sections[6]) {
+  size_t at = pad8(header_size);
+  size_t sizes[6] = {
+    (num_nodes + 1) * sizeof(uint64_t), (num_nodes + 1) * sizeof(uint64_t),
+    out_entries * sizeof(uint32_t), out_entries * weight_size,
+    in_entries * sizeof(uint32_t), in_entries * weight_size
+  };
+  for (int i = 0; i < 6; ++i) {
+    sections[i] = at;
+    at += pad8(sizes[i]);
+  }
+  return at;
+}
+
+template <class WT>
+template <class G>
+HubLabels<WT> HubLabels<WT>::build(const G& graph) {
+  std::vector<size_t> degrees(graph.size(), 0);
+  for (size_t v = 0; v < graph.size(); ++v) {
+    for (Edge<WT> edge : graph[v]) {
+      degrees[v]++;
+      degrees[edge.to]++;
+    }
+  }
+  std::vector<size_t> order(graph.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return degrees[a] > degrees[b]; });
+  return build_in_order(graph, order);
+}
+
+template <class WT>
+template <class G>
+HubLabels<WT> HubLabels<WT>::build(const G& graph, const ContractionHierarchy<WT>& ch) {
+  std::vector<size_t> order(graph.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ch.rank_of(a) > ch.rank_of(b); });
+  return build_in_order(graph, order);
+}
+
+template <class WT>
+template <class G>
+HubLabels<WT> HubLabels<WT>::build_in_order(const G& graph, const std::vector<size_t>& order) {
+  static_assert(std::is_same<typename G::weight_type, WT>::value, "the labels must have the weights of the graph");
+  HubLabelBuilder<G> builder(graph);
+  for (size_t i = 0; i < order.size(); ++i) builder.add_hub(order[i], (hub_id) i);
+
+  uint64_t num_nodes = graph.size();
+  uint64_t entries[2] = {0, 0};
+  for (size_t v = 0; v < num_nodes; ++v) {
+    entries[0] += builder.out_labels[v].hubs.size();
+    entries[1] += builder.in_labels[v].hubs.size();
+  }
+
+  size_t sections[6];
+  size_t bytes = hub_labels_layout(sizeof(Header), sizeof(WT), num_nodes, entries[0], entries[1], sections);
+  HubLabels<WT> labels;
+  labels.image.assign(bytes / sizeof(uint64_t), 0);
+  char* data = (char*) labels.image.data();
+
+  Header header;
+  std::memcpy(header.magic, hub_labels_magic, sizeof(header.magic));
+  header.version = hub_labels_version;
+  header.weight_size = sizeof(WT);
+  header.reserved = 0;
+  header.num_nodes = num_nodes;
+  header.out_entries = entries[0];
+  header.in_entries = entries[1];
+  std::memcpy(data, &header, sizeof(header));
+
+  // Out-labels first, then in-labels
+  for (int side = 0; side < 2; ++side) {
+    auto& side_labels = side == 0 ? builder.out_labels : builder.in_labels;
+    uint64_t* offsets = (uint64_t*) (data + sections[side]);
+    hub_id* hubs = (hub_id*) (data + sections[2 + 2 * side]);
+    WT* distances = (WT*) (data + sections[3 + 2 * side]);
+    offsets[0] = 0;
+    for (size_t v = 0; v < num_nodes; ++v) {
+      auto& label = side_labels[v];
+      std::copy(label.hubs.begin(), label.hubs.end(), hubs + offsets[v]);
+      std::copy(label.distances.begin(), label.distances.end(), distances + offsets[v]);
+      offsets[v + 1] = offsets[v] + label.hubs.size();
+      std::vector<hub_id>().swap(label.hubs);
+      std::vector<WT>().swap(label.distances);
+    }
+  }
+
+  labels.attach(data, bytes, false); // laid out just above
+  return labels;
+}
+
+template <class WT>
+void HubLabels<WT>::attach(const char* data, size_t size, bool validate) {
+  Header h;
+  if (size < sizeof(Header)) throw std::runtime_error("truncated hub labels");
+  std::memcpy(&h, data, sizeof(h));
+  if (!std::equal(h.magic, h.magic + sizeof(h.magic), hub_labels_magic) || h.version != hub_labels_version ||
+      h.weight_size != sizeof(WT))
+    throw std::runtime_error("not hub labels of this version and weight type");
+
+  // Counts too large for the file could wrap the layout around to a size which fits
+  size_t sections[6];
+  if (h.num_nodes >= size / sizeof(uint64_t) || h.out_entries > size / sizeof(hub_id) ||
+      h.in_entries > size / sizeof(hub_id) ||
+      hub_labels_layout(sizeof(Header), sizeof(WT), h.num_nodes, h.out_entries, h.in_entries, sections) > size)
+    throw std::runtime_error("truncated hub labels");
+  out_offsets = (const uint64_t*) (data + sections[0]);
+  in_offsets = (const uint64_t*) (data + sections[1]);
+  if (out_offsets[0] != 0 || out_offsets[h.num_nodes] != h.out_entries || in_offsets[0] != 0 ||
+      in_offsets[h.num_nodes] != h.in_entries)
+    throw std::runtime_error("corrupt hub labels");
+  if (validate) {
+    for (size_t v = 0; v < h.num_nodes; ++v)
+      if (out_offsets[v] > out_offsets[v + 1] || in_offsets[v] > in_offsets[v + 1])
+        throw std::runtime_error("corrupt hub labels: offsets out of order");
+  }
+
+  header = (const Header*) data;
+  out_hubs = (const hub_id*) (data + sections[2]);
+  out_distances = (const WT*) (data + sections[3]);
+  in_hubs = (const hub_id*) (data + sections[4]);
+  in_distances = (const WT*) (data + sections[5]);
+}
+
+template <class WT>
+void HubLabels<WT>::save(const std::string& path) const {
+  std::ofstream os(path, std::ios::binary);
+  size_t sections[6];
+  size_t bytes = header ? hub_labels_layout(sizeof(Header), sizeof(WT), header->num_nodes, header->out_entries,
+                                            header->in_entries, sections) : 0;
+  os.write((const char*) header, bytes);
+  if (!os) throw std::runtime_error("couldn't write hub labels to " + path);
+}
+
+template <class WT>
+HubLabels<WT> HubLabels<WT>::map(const std::string& path, bool validate) {
+  HubLabels<WT> labels;
+  labels.file = MappedFile(path);
+  labels.attach(labels.file.data(), labels.file.size(), validate); // on error, the file is unmapped again
+  return labels;
+}
+
+template <class WT>
+HubLabels<WT>& HubLabels<WT>::operator=(HubLabels&& other) noexcept {
+  if (this == &other) return *this;
+  image = std::move(other.image); // the buffer and the mapping move along, so the pointers into them stay valid
+  file = std::move(other.file);
+  header = other.header;
+  out_offsets = other.out_offsets;
+  in_offsets = other.in_offsets;
+  out_hubs = other.out_hubs;
+  out_distances = other.out_distances;
+  in_hubs = other.in_hubs;
+  in_distances = other.in_distances;
+
+  other.header = nullptr;
+  other.image.clear();
+  return *this;
+}
+
+template <class WT>
+inline WT HubLabels<WT>::distance(size_t source, size_t sink) const {
+  uint64_t out_begin = out_offsets[source];
+  uint64_t in_begin = in_offsets[sink];
+  return intersect(out_hubs + out_begin, out_distances + out_begin, out_offsets[source + 1] - out_begin,
+                   in_hubs + in_begin, in_distances + in_begin, in_offsets[sink + 1] - in_begin);
+}
+
+/**
+ * @fn HubLabels::intersect
+ * @brief Merges two sorted labels, adding up the distances of the hubs they have in common. With SSE2, blocks of
+ * four hubs of each are compared all against all at once, and only blocks with a match are looked at one by one.
+ * @return The smallest sum, or the largest WT if they have no hub in common
+ */
+template <class WT>
+inline WT HubLabels<WT>::intersect(const hub_id* a, const WT* a_distances, size_t na,
+                                   const hub_id* b, const WT* b_distances, size_t nb) {
+  WT best = std::numeric_limits<WT>::max();
+  size_t i = 0, j = 0;
+#if defined(__SSE2__)
+  while (i + 4 <= na && j + 4 <= nb) {
+    __m128i va = _mm_loadu_si128((const __m128i*) (a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i*) (b + j));
+    __m128i equal = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+      _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                   _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+    if (_mm_movemask_epi8(equal)) {
+      for (size_t x = i; x < i + 4; ++x)
+        for (size_t y = j; y < j + 4; ++y)
+          if (a[x] == b[y]) best = std::min(best, (WT) (a_distances[x] + b_distances[y]));
+    }
+
+    // A block whose last hub is no larger than the other's last can't match anything further on
+    hub_id a_last = a[i + 3];
+    hub_id b_last = b[j + 3];
+    if (a_last <= b_last) i += 4;
+    if (b_last <= a_last) j += 4;
+  }
+#endif
+  while (i < na && j < nb) {
+    if (a[i] == b[j]) {
+      best = std::min(best, (WT) (a_distances[i] + b_distances[j]));
+      ++i;
+      ++j;
+    } else if (a[i] < b[j]) ++i;
+    else ++j;
+  }
+  return best;
+}
+
+#endif // _HUB_LABELS_CPP_INCLUDED
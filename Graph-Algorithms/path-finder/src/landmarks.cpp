@@ -0,0 +1,237 @@
+/**
+ * @file landmarks.cpp
+ * @brief presents the implementation of landmark selection and the ALT lower bounds
+ */
+
+#ifndef _LANDMARKS_CPP_INCLUDED
+#define _LANDMARKS_CPP_INCLUDED
+
+#include <landmarks.hpp>
+#include <parallel.hpp>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+
+/**
+ * @class LandmarkSearch
+ * @brief Dijkstra from one node to every node it reaches, with the arrays kept from one search to the next
+ */
+template <class G>
+class LandmarkSearch {
+public:
+  typedef typename G::weight_type weight_type;
+  typedef typename DefaultQueue<G, void>::type queue_type;
+  static constexpr weight_type unreached = std::numeric_limits<weight_type>::max();
+
+  std::vector<weight_type> distances;   // unreached for the nodes the search didn't reach
+  std::vector<size_t> prevs;
+  std::vector<size_t> order;            // the reached nodes in the order they were settled
+
+  explicit LandmarkSearch(size_t size)
+    : distances(size), prevs(size), queue(make_queue<queue_type, weight_type>(distances.data())) {
+    queue.reserve_positions(size);
+  }
+
+  LandmarkSearch(const LandmarkSearch&) = delete;
+  LandmarkSearch& operator=(const LandmarkSearch&) = delete;
+
+  void run(const G& graph, size_t source) {
+    std::fill(distances.begin(), distances.end(), unreached);
+    order.clear();
+    queue.clear();
+    distances[source] = 0;
+    prevs[source] = source;
+    queue.push(source);
+
+    while (!queue.empty()) {
+      size_t v = queue.top();
+      queue.pop();
+      order.push_back(v);
+      for (Edge<weight_type> edge : graph[v]) {
+        weight_type alt_distance = distances[v] + edge.weight;
+        if (alt_distance >= distances[edge.to]) continue;
+        distances[edge.to] = alt_distance;
+        prevs[edge.to] = v;
+        if (queue.contains(edge.to)) queue.decrease_key(edge.to);
+        else queue.push(edge.to);
+      }
+    }
+  }
+
+  /**
+   * @fn LandmarkSearch::column
+   * @brief The distances of the last search as stored by Landmarks
+   * @param overflow Set if a distance doesn't fit
+   */
+  std::vector<uint32_t> column(std::atomic<bool>& overflow) const {
+    constexpr uint32_t unreachable = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> result(distances.size());
+    for (size_t v = 0; v < distances.size(); ++v) {
+      if (distances[v] == unreached) result[v] = unreachable;
+      else if ((uint64_t) distances[v] >= unreachable) {
+        result[v] = unreachable;
+        overflow = true;
+      } else result[v] = (uint32_t) distances[v];
+    }
+    return result;
+  }
+
+private:
+  queue_type queue;
+};
+
+/**
+ * @fn farthest_landmark
+ * @brief The node furthest from every landmark picked so far, where nodes no landmark reaches count as furthest
+ * @param closest The distance to each node from the landmark nearest to it
+ */
+static size_t farthest_landmark(const std::vector<uint32_t>& closest, const std::vector<bool>& picked) {
+  size_t best = 0;
+  bool found = false;
+  for (size_t v = 0; v < closest.size(); ++v) {
+    if (picked[v]) continue;
+    if (!found || closest[v] > closest[best]) best = v;
+    found = true;
+  }
+  return best;
+}
+
+/**
+ * @fn avoid_landmark
+ * @brief Picks the next landmark from a shortest path tree rooted at a random node. Each node weighs how much
+ * its distance from the root exceeds the lower bound the landmarks give for it, and subtrees which already hold a
+ * landmark weigh nothing. The landmark is the leaf reached by always descending into the heaviest subtree.
+ * @param search A search from the root
+ * @param from_columns The distances from the landmarks picked so far
+ */
+template <class G>
+static size_t avoid_landmark(const LandmarkSearch<G>& search, size_t root,
+                             const std::vector<std::vector<uint32_t>>& from_columns,
+                             const std::vector<bool>& picked, std::mt19937_64& rng) {
+  constexpr uint32_t unreachable = std::numeric_limits<uint32_t>::max();
+  size_t n = search.distances.size();
+  std::vector<double> sizes(n, 0);
+  std::vector<bool> has_landmark(n, false);
+  std::vector<size_t> child_offsets(n + 1, 0);
+  std::vector<size_t> children(search.order.size());
+
+  for (size_t v : search.order) {
+    double bound = 0;
+    for (const std::vector<uint32_t>& from : from_columns)
+      if (from[v] != unreachable && from[root] != unreachable)
+        bound = std::max(bound, (double) from[v] - (double) from[root]);
+    sizes[v] = (double) search.distances[v] - bound;
+    if (v != root) child_offsets[search.prevs[v] + 1]++;
+  }
+  for (size_t v = 0; v < n; ++v) child_offsets[v + 1] += child_offsets[v];
+  std::vector<size_t> fill(child_offsets.begin(), child_offsets.end() - 1);
+  for (size_t v : search.order)
+    if (v != root) children[fill[search.prevs[v]]++] = v;
+
+  // Children are settled after their parents, so going backwards adds up the subtrees from the leaves
+  for (auto it = search.order.rbegin(); it != search.order.rend(); ++it) {
+    size_t v = *it;
+    if (picked[v]) has_landmark[v] = true;
+    if (has_landmark[v]) sizes[v] = 0;
+    if (v == root) break;
+    size_t parent = search.prevs[v];
+    sizes[parent] += sizes[v];
+    if (has_landmark[v]) has_landmark[parent] = true;
+  }
+
+  if (sizes[root] <= 0) { // the landmarks bound every distance exactly
+    size_t v;
+    do v = rng() % n; while (picked[v]);
+    return v;
+  }
+
+  size_t v = root;
+  while (true) {
+    size_t heaviest = v;
+    for (size_t c = child_offsets[v]; c < child_offsets[v + 1]; ++c)
+      if (sizes[children[c]] > 0 && (heaviest == v || sizes[children[c]] > sizes[heaviest])) heaviest = children[c];
+    if (heaviest == v) return v;
+    v = heaviest;
+  }
+}
+
+template <class WT>
+template <class G>
+Landmarks<WT> Landmarks<WT>::build(const G& graph, size_t count, Selection selection, unsigned nthreads,
+                                   uint64_t seed) {
+  static_assert(std::is_integral<WT>::value, "landmark distances are stored as 32 bit integers");
+  size_t n = graph.size();
+  Landmarks<WT> result;
+  count = std::min(count, n);
+  result.count = count;
+  if (count == 0) return result;
+
+  // Each landmark is picked using the distances from the ones before it
+  std::mt19937_64 rng(seed);
+  std::atomic<bool> overflow(false);
+  std::vector<std::vector<uint32_t>> from_columns;
+  std::vector<uint32_t> closest(n, unreachable);
+  std::vector<bool> picked(n, false);
+  LandmarkSearch<G> search(n);
+  for (size_t i = 0; i < count; ++i) {
+    size_t next;
+    if (selection == Selection::avoid || i == 0) {
+      size_t root = rng() % n;
+      search.run(graph, root);
+      if (selection == Selection::avoid) next = avoid_landmark(search, root, from_columns, picked, rng);
+      else next = search.order.back(); // settled last, so furthest from the root
+    } else next = farthest_landmark(closest, picked);
+
+    picked[next] = true;
+    result.landmarks.push_back(next);
+    search.run(graph, next);
+    from_columns.push_back(search.column(overflow));
+    for (size_t v = 0; v < n; ++v) closest[v] = std::min(closest[v], from_columns.back()[v]);
+  }
+
+  // The searches towards the landmarks are independent
+  typedef CsrGraph<typename G::data_type, WT> reverse_graph_type;
+  reverse_graph_type reverse = reverse_graph_type::reverse_of(graph);
+  std::vector<std::vector<uint32_t>> to_columns(count);
+  std::atomic<size_t> next_landmark(0);
+  run_threads(std::min(nthreads, (unsigned) count), [&](unsigned) {
+    LandmarkSearch<reverse_graph_type> reverse_search(n);
+    for (size_t i = next_landmark++; i < count; i = next_landmark++) {
+      reverse_search.run(reverse, result.landmarks[i]);
+      to_columns[i] = reverse_search.column(overflow);
+    }
+  });
+  if (overflow) throw std::overflow_error("landmark distances don't fit in 32 bits");
+
+  // Node by node, so that the bounds for one node are read from one place
+  result.from_landmark.resize(n * count);
+  result.to_landmark.resize(n * count);
+  for (size_t v = 0; v < n; ++v) {
+    for (size_t i = 0; i < count; ++i) {
+      result.from_landmark[v * count + i] = from_columns[i][v];
+      result.to_landmark[v * count + i] = to_columns[i][v];
+    }
+  }
+  return result;
+}
+
+template <class WT>
+inline double Landmarks<WT>::lower_bound(size_t from, size_t to) const {
+  const distance_type* from_v = from_landmark.data() + from * count;
+  const distance_type* from_t = from_landmark.data() + to * count;
+  const distance_type* to_v = to_landmark.data() + from * count;
+  const distance_type* to_t = to_landmark.data() + to * count;
+
+  // Landmarks which can't reach or be reached by both nodes don't bound the distance between them
+  int64_t best = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (to_v[i] != unreachable && to_t[i] != unreachable)
+      best = std::max(best, (int64_t) to_v[i] - (int64_t) to_t[i]);
+    if (from_t[i] != unreachable && from_v[i] != unreachable)
+      best = std::max(best, (int64_t) from_t[i] - (int64_t) from_v[i]);
+  }
+  return (double) best;
+}
+
+#endif // _LANDMARKS_CPP_INCLUDED
@@ -45,11 +45,7 @@ template <class Distance, class Coordinate, class DistanceFn>
 class DistanceToEnd {
 public:
   DistanceToEnd(const vector<Coordinate>& coordinates, size_t end_index)
-    : end_index(end_index), coordinates(coordinates) {
-
-    size_t numel = coordinates.size();
-    set = (bool*) calloc(numel * sizeof(bool), 1);
-    distances = (Distance*) malloc(numel * sizeof(Distance));
+    : end_index(end_index), coordinates(coordinates), set(coordinates.size(), false), distances(coordinates.size()) {
     distances[end_index] = 0;
     set[end_index] = true;
   };
@@ -61,19 +57,16 @@ public:
     return distances[i];
   }
 
-  ~DistanceToEnd(){
-    free(set);
-    free(distances);
-  }
-
 private:
-  bool* set;
   size_t end_index;
 
   DistanceFn distanceFn;
 
   const vector<Coordinate> coordinates;
-  Distance* distances;
+
+  // Vectors rather than malloc'd arrays, since PathFinder keeps its own copy of the heuristic
+  vector<bool> set;
+  vector<Distance> distances;
 };
 
 void run_astar() {
@@ -1,10 +1,17 @@
 /**
  * @file pq-test.cpp
- * @brief tests the performance difference between the two implementations of the priority queue
+ * @brief tests the performance difference between the two implementations of the priority queue,
+ * and of the heap with elements which index their positions directly. Also checks (and times)
+ * re-sifting elements in place after their priorities change, and the monotone integer queues.
  */
 
 #include "priority-queue.hpp"
+#include "monotone-queue.hpp"
 #include <iostream>
+#include <vector>
+#include <random>
+#include <limits>
+#include <cassert>
 
 using namespace std;
 
@@ -28,10 +35,127 @@ void time_test(const string& name, priority_queue<T, heap>& queue){
   cout << name << ":\t" << elapsed_secs << " [seconds] elapsed" << endl;
 }
 
+/**
+ * @class CompareKeys
+ * @brief Orders ids by keys stored outside of the queue, like the distances in a path finder
+ */
+struct CompareKeys {
+  const long* keys;
+  bool operator()(size_t a, size_t b) const { return keys[a] < keys[b]; }
+};
+
+typedef priority_queue<size_t, true, CompareKeys> keyed_queue;
+
+/**
+ * @fn test_decrease_key
+ * @brief Changes the keys of random elements, re-sifting them with decrease_key and update,
+ * erases some, and checks that everything else comes out once and in order
+ */
+void test_decrease_key() {
+  mt19937 rng(0);
+  vector<long> keys(N);
+  for (size_t i = 0; i < N; ++i) keys[i] = rng() % (10 * N);
+
+  keyed_queue queue(CompareKeys{keys.data()});
+  for (size_t i = 0; i < N; ++i) queue.push(i);
+
+  for (int i = 0; i < N; ++i) {
+    size_t v = rng() % N;
+    if (i % 2) {
+      keys[v] -= rng() % 1000;
+      queue.decrease_key(v);
+    } else {
+      keys[v] = rng() % (10 * N);
+      queue.update(v);
+    }
+  }
+  for (size_t v = 0; v < N; v += 10) queue.erase(v);
+  assert(queue.size() == N - N / 10);
+
+  vector<bool> popped(N, false);
+  long last = numeric_limits<long>::min();
+  while (!queue.empty()) {
+    size_t v = queue.top();
+    assert(keys[v] >= last);
+    assert(v % 10 != 0 && !popped[v]);
+    assert(queue.contains(v));
+    last = keys[v];
+    popped[v] = true;
+    queue.pop();
+    assert(!queue.contains(v));
+  }
+  cout << "decrease_key/update:\tpassed" << endl;
+}
+
+static inline uint64_t mix(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// The heap takes a comparison of the keys, the monotone queues the keys themselves
+template <class Queue>
+static Queue make_queue(const long* keys) {
+  if constexpr (is_constructible<Queue, const long*>::value) return Queue(keys);
+  else return Queue(CompareKeys{keys});
+}
+
+/**
+ * @fn time_dijkstra
+ * @brief Times Dijkstra's algorithm on a random graph with N nodes, each with 4 out-edges of weight
+ * 1 to 1000, using the given queue
+ * @param in_place Whether to update queued nodes with decrease_key, or by erasing and pushing them again
+ * @return The distances from node 0
+ */
+template <class Queue>
+vector<long> time_dijkstra(const string& name, bool in_place=true) {
+  vector<long> keys(N, numeric_limits<long>::max());
+  Queue queue = make_queue<Queue>(keys.data());
+
+  clock_t begin = clock();
+  keys[0] = 0;
+  queue.push(0);
+  long last = 0;
+  while (!queue.empty()) {
+    size_t v = queue.top();
+    queue.pop();
+    assert(keys[v] >= last);
+    last = keys[v];
+    for (uint64_t i = 0; i < 4; ++i) {
+      uint64_t r = mix(4 * v + i);
+      size_t u = r % N;
+      long key = keys[v] + 1 + (long) ((r >> 32) % 1000);
+      if (key >= keys[u]) continue;
+      keys[u] = key;
+      if (!queue.contains(u)) queue.push(u);
+      else if (in_place) queue.decrease_key(u);
+      else {
+        queue.erase(u);
+        queue.push(u);
+      }
+    }
+  }
+  clock_t end = clock();
+  double elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
+  cout << name << ":\t" << elapsed_secs << " [seconds] elapsed" << endl;
+  return keys;
+}
+
 int main() {
   priority_queue<int, false> queue_set;
   time_test("Set", queue_set);
 
   priority_queue<int, true> queue_heap;
   time_test("Heap", queue_heap);
-}
\ No newline at end of file
+
+  priority_queue<size_t, true> queue_ids; // positions in a flat array instead of a map
+  time_test("Heap (size_t)", queue_ids);
+
+  test_decrease_key();
+  auto distances = time_dijkstra<keyed_queue>("Dijkstra, erase + push", false);
+  auto decrease_key = time_dijkstra<keyed_queue>("Dijkstra, decrease_key");
+  auto radix = time_dijkstra<radix_heap<long>>("Dijkstra, radix heap");
+  auto buckets = time_dijkstra<bucket_queue<long>>("Dijkstra, bucket queue");
+  assert(decrease_key == distances && radix == distances && buckets == distances);
+}